@@ -0,0 +1,36 @@
+/**
+ * Heap allocations counter for the benchmarks.
+ *
+ * Replaces the global `operator new`, so should be included in exactly
+ * one translation unit of a benchmark.
+ */
+
+#ifndef __Syntax_Benchmarks_Alloc_Counter_h
+#define __Syntax_Benchmarks_Alloc_Counter_h
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace bench {
+
+/**
+ * Number of allocations since the program start.
+ */
+inline std::atomic<size_t> allocations{0};
+
+}  // namespace bench
+
+void* operator new(size_t size) {
+  bench::allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+#endif
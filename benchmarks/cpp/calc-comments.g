@@ -0,0 +1,36 @@
+/**
+ * Calculator grammar with line and block comments, for the comment-heavy
+ * inputs of the `comments` benchmark.
+ */
+
+%lex
+
+%%
+
+\/\/.*                        %empty
+
+\/\*([^*]|\*+[^*\/])*\*+\/    %empty
+
+\s+                           %empty
+
+\d+                           NUMBER
+
+/lex
+
+%{
+
+using Value = int;
+
+%}
+
+%left '+'
+%left '*'
+
+%%
+
+E
+  : E '+' E   { $$ = $1 + $3 }
+  | E '*' E   { $$ = $1 * $3 }
+  | '(' E ')' { $$ = $2 }
+  | NUMBER    { $$ = std::stoi(std::string{$1}) }
+  ;
@@ -0,0 +1,45 @@
+/**
+ * Comment-heavy inputs benchmark: tokens separated by long runs of skipped
+ * line and block comments. Also checks that a long run of skipped tokens
+ * doesn't grow the stack.
+ *
+ *   ./comments-regex [terms-count] [comments-per-term]
+ *   ./comments-dfa [terms-count] [comments-per-term]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "inputs.h"
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+static void run(const char* name, const std::string& input, int expected) {
+  PARSER_CLASS parser;
+
+  auto start = std::chrono::steady_clock::now();
+  auto result = parser.parse(input);
+  auto end = std::chrono::steady_clock::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+
+  std::printf("%-10s %-20s %10.2f MB/s%s\n", LEXER_NAME, name,
+              input.size() / seconds / 1e6,
+              result != expected ? "  MISMATCHED RESULT" : "");
+}
+
+int main(int argc, char** argv) {
+  auto count = argc > 1 ? std::stoul(argv[1]) : 10000;
+  auto comments = argc > 2 ? std::stoul(argv[2]) : 20;
+
+  run("commented terms", bench::makeCommentedInput(count, comments),
+      (int)count);
+
+  // One run of a million skipped comments.
+  run("comments run", bench::makeCommentedInput(2, 1000000), 2);
+
+  return 0;
+}
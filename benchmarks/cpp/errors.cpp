@@ -0,0 +1,83 @@
+/**
+ * Rejected inputs benchmark: parses many small invalid messages, with the
+ * `tryParse` (the error record, formatting no message), and with the
+ * `parse`, catching the `SyntaxErrorException`.
+ *
+ *   ./errors-regex [messages-count]
+ *   ./errors-dfa [messages-count]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "alloc-counter.h"
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+template <typename Parse>
+void run(const char* name, const std::vector<std::string>& messages,
+         size_t count, Parse&& parse) {
+  // Warm-up: compiles the regexes, grows the stacks.
+  for (const auto& message : messages) {
+    parse(message);
+  }
+
+  auto allocations = bench::allocations.load();
+  auto start = std::chrono::steady_clock::now();
+
+  size_t errors = 0;
+  for (size_t i = 0; i < count; i++) {
+    errors += parse(messages[i % messages.size()]);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  allocations = bench::allocations.load() - allocations;
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+
+  std::printf("%-10s %-10s %10zu errors %12.0f parses/s %8.3f allocs/parse\n",
+              LEXER_NAME, name, errors, count / seconds,
+              (double)allocations / count);
+}
+
+int main(int argc, char** argv) {
+  auto count = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+  // Unexpected tokens, unexpected input, and unexpected end.
+  std::vector<std::string> messages;
+  for (size_t i = 0; i < 100; i++) {
+    auto term = "(" + std::to_string(i) + " + " + std::to_string(i % 7) + ")";
+    switch (i % 3) {
+      case 0:
+        messages.push_back(term + " * * 2");
+        break;
+      case 1:
+        messages.push_back(term + " # 2");
+        break;
+      default:
+        messages.push_back(term + " * (");
+        break;
+    }
+  }
+
+  PARSER_CLASS parser;
+
+  run("tryParse", messages, count, [&](const std::string& message) {
+    return !parser.tryParse(message).ok();
+  });
+
+  run("parse", messages, count, [&](const std::string& message) {
+    try {
+      parser.parse(message);
+      return false;
+    } catch (const SyntaxErrorException&) {
+      return true;
+    }
+  });
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * Generated inputs for the benchmarks.
+ */
+
+#ifndef __Syntax_Benchmarks_Inputs_h
+#define __Syntax_Benchmarks_Inputs_h
+
+#include <string>
+
+namespace bench {
+
+/**
+ * Arithmetic expression of `count` terms like `(12 + 345) * 6 + `.
+ */
+inline std::string makeCalcInput(size_t count) {
+  std::string input;
+  for (size_t i = 0; i < count; i++) {
+    input += "(" + std::to_string(i % 1000) + " + " +
+             std::to_string(i % 77) + ") * " + std::to_string(i % 9) + " + ";
+  }
+  input += "1";
+  return input;
+}
+
+/**
+ * Sum of `count` ones, with `comments` line and block comments
+ * before each term.
+ */
+inline std::string makeCommentedInput(size_t count, size_t comments) {
+  std::string input;
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = 0; j < comments; j++) {
+      input += j % 2 == 0 ? "// line comment\n" : "/* block\n * comment */\n";
+    }
+    input += i + 1 < count ? "1 +\n" : "1\n";
+  }
+  return input;
+}
+
+/**
+ * Lines of `count` statements like `(12 + 3) * 4;`.
+ */
+inline std::string makeStatementsInput(size_t count) {
+  std::string input;
+  for (size_t i = 0; i < count; i++) {
+    input += "(" + std::to_string(i % 100) + " + " + std::to_string(i % 7) +
+             ") * " + std::to_string(i % 9) + ";\n";
+  }
+  return input;
+}
+
+/**
+ * Arithmetic expression of about `size` bytes, see `makeCalcInput`.
+ */
+inline std::string makeCalcInputOfSize(size_t size) {
+  return makeCalcInput(size / 18 + 1);
+}
+
+/**
+ * S-expression of about `size` bytes: a list of definitions like
+ * `(def f12 (+ x 12 "str"))`.
+ */
+inline std::string makeSExpInputOfSize(size_t size) {
+  std::string input = "(";
+  for (size_t i = 0; input.size() < size; i++) {
+    auto n = std::to_string(i % 1000);
+    input += "(def f" + n + " (+ x " + n + " \"str\")) ";
+  }
+  input += ")";
+  return input;
+}
+
+/**
+ * JSON array of about `size` bytes, of the objects like
+ * `{"id": 12, "name": "item", "tags": ["a", "b"], "score": -1.5e3, ...}`.
+ */
+inline std::string makeJsonInputOfSize(size_t size) {
+  std::string input = "[";
+  for (size_t i = 0; input.size() < size; i++) {
+    if (i > 0) {
+      input += ",\n";
+    }
+    input += "{\"id\": " + std::to_string(i) +
+             ", \"name\": \"item\", \"tags\": [\"a\", \"b\"], "
+             "\"score\": -1.5e3, \"active\": true, \"next\": null}";
+  }
+  input += "]";
+  return input;
+}
+
+}  // namespace bench
+
+#endif
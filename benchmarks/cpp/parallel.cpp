@@ -0,0 +1,65 @@
+/**
+ * Parallel chunked lexing benchmark: parses one large input with
+ * `parseParallel`, splitting it at the "+" separators, compared to the
+ * single-threaded `parse`.
+ *
+ *   ./parallel-regex [max-threads] [expressions]
+ *   ./parallel-dfa [max-threads] [expressions]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "inputs.h"
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+template <typename Parse>
+static double measure(size_t size, Parse&& parse) {
+  auto start = std::chrono::steady_clock::now();
+  parse();
+  auto end = std::chrono::steady_clock::now();
+  return size / std::chrono::duration<double>(end - start).count() / 1e6;
+}
+
+int main(int argc, char** argv) {
+  size_t maxThreads = argc > 1 ? std::stoul(argv[1])
+                               : std::thread::hardware_concurrency();
+  size_t count = argc > 2 ? std::stoul(argv[2]) : 1000000;
+
+  const auto input = bench::makeCalcInput(count);
+
+  PARSER_CLASS parser;
+  Value expected;
+
+  auto baseline = measure(input.size(), [&] { expected = parser.parse(input); });
+
+  std::printf("%-10s parse %16.2f MB/s\n", LEXER_NAME, baseline);
+
+  // 1, 2, 4, ... and the maximum itself.
+  std::vector<size_t> counts;
+  for (size_t n = 1; n < maxThreads; n *= 2) {
+    counts.push_back(n);
+  }
+  counts.push_back(maxThreads > 0 ? maxThreads : 1);
+
+  for (auto threadsCount : counts) {
+    // Warm up the reused token buffers.
+    auto result = parser.parseParallel(input, "+", threadsCount);
+
+    auto throughput = measure(input.size(), [&] {
+      result = parser.parseParallel(input, "+", threadsCount);
+    });
+
+    std::printf("%-10s %3zu threads %10.2f MB/s %6.2fx speedup%s\n",
+                LEXER_NAME, threadsCount, throughput, throughput / baseline,
+                result != expected ? "  MISMATCHED RESULT" : "");
+  }
+
+  return 0;
+}
@@ -0,0 +1,61 @@
+/**
+ * Reparsing benchmark: edits one digit of a statement at the start, in the
+ * middle, and at the end of a large input, and compares the `tryReparse`
+ * latency with the full `tryParse` of the text. Only the lexing is
+ * incremental: a reparse restarts from the checkpoint before the edit, and
+ * parses to the end, so it's cheap only near the end of the input.
+ *
+ *   ./reparse-regex [statements-count]
+ *   ./reparse-dfa [statements-count]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "inputs.h"
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+template <typename Parse>
+double measure(size_t count, Parse&& parse) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; i++) {
+    parse(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         count;
+}
+
+int main(int argc, char** argv) {
+  auto count = argc > 1 ? std::stoul(argv[1]) : 100000;
+  auto input = bench::makeStatementsInput(count);
+
+  PARSER_CLASS parser;
+
+  auto full = measure(5, [&](size_t) { parser.tryParse(input); });
+
+  std::printf("%-10s %-10s %10zu lines %12.1f us\n", LEXER_NAME, "tryParse",
+              count, full);
+
+  parser.tryParseEditable(input);
+
+  for (auto [name, at] : {std::pair{"start", 0.0}, std::pair{"middle", 0.5},
+                          std::pair{"end", 1.0}}) {
+    // The first digit of the statement, edited back and forth.
+    auto offset = input.rfind('(', (size_t)(at * (input.size() - 1))) + 1;
+
+    auto reparse = measure(200, [&](size_t i) {
+      std::string_view digit = i % 2 == 0 ? "5" : "1";
+      parser.tryReparse(Edit{offset, 1, digit});
+    });
+
+    std::printf("%-10s %-10s %10zu lines %12.1f us %8.1fx\n", LEXER_NAME,
+                name, count, reparse, full / reparse);
+  }
+
+  return 0;
+}
@@ -0,0 +1,55 @@
+/**
+ * Parser reuse benchmark: parses many small messages with one parser
+ * instance, and reports heap allocations per parse in the steady state.
+ *
+ *   ./reuse-regex [messages-count]
+ *   ./reuse-dfa [messages-count]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "alloc-counter.h"
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+int main(int argc, char** argv) {
+  auto count = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+  std::vector<std::string> messages;
+  for (size_t i = 0; i < 100; i++) {
+    messages.push_back("(" + std::to_string(i) + " + " +
+                       std::to_string(i * 7 % 13) + ") * " +
+                       std::to_string(i % 5 + 1));
+  }
+
+  PARSER_CLASS parser;
+
+  // Warm-up: compiles the regexes, grows the stacks.
+  for (const auto& message : messages) {
+    parser.parse(message);
+  }
+
+  auto allocations = bench::allocations.load();
+  auto start = std::chrono::steady_clock::now();
+
+  long long checksum = 0;
+  for (size_t i = 0; i < count; i++) {
+    checksum += parser.parse(messages[i % messages.size()]);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  allocations = bench::allocations.load() - allocations;
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+
+  std::printf("%-10s %10zu parses %12.0f parses/s %8.3f allocs/parse (%lld)\n",
+              LEXER_NAME, count, count / seconds, (double)allocations / count,
+              checksum);
+
+  return 0;
+}
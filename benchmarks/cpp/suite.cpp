@@ -0,0 +1,110 @@
+/**
+ * Throughput suite: parses generated inputs of a grammar from 1 KB up to
+ * the max size (16 MB by default, e.g. `1G` for 1 GB), repeating each
+ * parse for at least a fraction of a second, and reports the MB/s, the
+ * tokens/s, and the heap allocations per token, with the size of the
+ * static tables of the parser.
+ *
+ *   ./suite-calc-regex [max-size]
+ *   ./suite-json-dfa [max-size]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "alloc-counter.h"
+#include "inputs.h"
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+/**
+ * Size in bytes, with the optional `K`, `M`, or `G` suffix.
+ */
+static size_t parseSize(const std::string& size) {
+  size_t suffix = 0;
+  auto value = std::stoul(size, &suffix);
+  switch (suffix < size.size() ? size[suffix] : ' ') {
+    case 'G':
+      return value << 30;
+    case 'M':
+      return value << 20;
+    case 'K':
+      return value << 10;
+    default:
+      return value;
+  }
+}
+
+static std::string formatSize(size_t size) {
+  if (size >= (1 << 30)) {
+    return std::to_string(size >> 30) + "G";
+  }
+  if (size >= (1 << 20)) {
+    return std::to_string(size >> 20) + "M";
+  }
+  return std::to_string(size >> 10) + "K";
+}
+
+static size_t countTokens(Tokenizer& tokenizer, std::string_view input) {
+  tokenizer.initString(input);
+  size_t count = 0;
+  while (tokenizer.getNextToken().type != TokenType::__EOF) {
+    count++;
+  }
+  return count;
+}
+
+int main(int argc, char** argv) {
+  auto maxSize = parseSize(argc > 1 ? argv[1] : "16M");
+
+  PARSER_CLASS parser;
+
+  std::printf("%s/%s: %zu bytes of tables\n", GRAMMAR_NAME, LEXER_NAME,
+              PARSER_CLASS::tablesSize());
+
+  // The output of the parse hooks of the examples is dropped.
+  std::cout.setstate(std::ios::badbit);
+
+  for (size_t size = 1 << 10; size <= maxSize; size <<= 2) {
+    auto input = MAKE_INPUT(size);
+    auto tokens = countTokens(parser.tokenizer, input);
+
+    auto parse = [&] {
+      parser.parse(input);
+#if SYNTAX_PARSER_ARENA
+      parser.arena().release();
+#endif
+    };
+
+    // Warm-up: compiles the regexes, grows the stacks.
+    parse();
+
+    auto allocations = bench::allocations.load();
+    auto start = std::chrono::steady_clock::now();
+
+    size_t iterations = 0;
+    double seconds = 0;
+    while (seconds < 0.2) {
+      parse();
+      iterations++;
+      seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    }
+
+    allocations = bench::allocations.load() - allocations;
+
+    std::printf(
+        "%s/%s/%-4s %12.0f ns %10.2f MB/s %12.0f tokens/s %8.3f allocs/token\n",
+        GRAMMAR_NAME, LEXER_NAME, formatSize(size).c_str(),
+        seconds / iterations * 1e9, input.size() * iterations / seconds / 1e6,
+        tokens * iterations / seconds,
+        (double)allocations / (tokens * iterations));
+  }
+
+  return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * Multi-threaded scaling benchmark: each thread parses the same input
+ * with its own parser instance, sharing only the read-only tables.
+ * Reports the total throughput, and the speedup over one thread.
+ *
+ *   ./threads-regex [max-threads] [rounds]
+ *   ./threads-dfa [max-threads] [rounds]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "inputs.h"
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+int main(int argc, char** argv) {
+  size_t maxThreads = argc > 1 ? std::stoul(argv[1])
+                               : std::thread::hardware_concurrency();
+  size_t rounds = argc > 2 ? std::stoul(argv[2]) : 20;
+
+  const auto input = bench::makeCalcInput(20000);
+  const auto expected = PARSER_CLASS{}.parse(input);
+
+  // 1, 2, 4, ... and the maximum itself.
+  std::vector<size_t> counts;
+  for (size_t n = 1; n < maxThreads; n *= 2) {
+    counts.push_back(n);
+  }
+  counts.push_back(maxThreads > 0 ? maxThreads : 1);
+
+  double baseline = 0;
+
+  for (auto threadsCount : counts) {
+    std::vector<std::thread> threads;
+    std::vector<int> failures(threadsCount, 0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t t = 0; t < threadsCount; t++) {
+      threads.emplace_back([&, t] {
+        PARSER_CLASS parser;
+        for (size_t i = 0; i < rounds; i++) {
+          if (parser.parse(input) != expected) {
+            failures[t]++;
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double throughput = threadsCount * rounds * input.size() / seconds / 1e6;
+
+    if (threadsCount == 1) {
+      baseline = throughput;
+    }
+
+    size_t failed = 0;
+    for (auto f : failures) {
+      failed += f;
+    }
+
+    std::printf("%-10s %3zu threads %10.2f MB/s %6.2fx speedup%s\n",
+                LEXER_NAME, threadsCount, throughput, throughput / baseline,
+                failed > 0 ? "  MISMATCHED RESULTS" : "");
+  }
+
+  return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * Tokenizer micro-benchmark: tokens per second, and heap allocations
+ * per token, on a generated arithmetic expression.
+ *
+ *   ./tokenizer-regex [expressions-count]
+ *   ./tokenizer-dfa [expressions-count]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "alloc-counter.h"
+#include "inputs.h"
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+static size_t tokenize(Tokenizer& tokenizer, std::string_view input) {
+  tokenizer.initString(input);
+  size_t count = 0;
+  while (tokenizer.getNextToken().type != TokenType::__EOF) {
+    count++;
+  }
+  return count;
+}
+
+int main(int argc, char** argv) {
+  auto count = argc > 1 ? std::stoul(argv[1]) : 100000;
+  auto input = bench::makeCalcInput(count);
+
+  PARSER_CLASS parser;
+  auto& tokenizer = parser.tokenizer;
+
+  // Warm-up: compiles the regexes, grows the tokenizer states stack.
+  tokenize(tokenizer, input);
+
+  auto allocations = bench::allocations.load();
+  auto start = std::chrono::steady_clock::now();
+
+  auto tokens = tokenize(tokenizer, input);
+
+  auto end = std::chrono::steady_clock::now();
+  allocations = bench::allocations.load() - allocations;
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+
+  std::printf("%-10s %10zu tokens %10.2f MB/s %12.0f tokens/s %8.3f allocs/token\n",
+              LEXER_NAME, tokens, input.size() / seconds / 1e6,
+              tokens / seconds, (double)allocations / tokens);
+
+  return 0;
+}
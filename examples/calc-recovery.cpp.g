@@ -0,0 +1,53 @@
+/**
+ * Generated parser in C++, with the yacc-style error recovery: a statement
+ * with a syntax error is skipped up to the next `;`, and parsing continues.
+ *
+ * ./bin/syntax -g examples/calc-recovery.cpp.g -m lalr1 -o CalcRecovery.h
+ *
+ *   #include "CalcRecovery.h"
+ *
+ *   CalcRecovery parser;
+ *
+ *   auto result = parser.tryParse("1 + 2; 3 * * 4; 5;");
+ *
+ *   *result.value;                  // 8, the sum of the valid statements
+ *   parser.syntaxErrors().size();   // 1, the second `*`
+ */
+
+%lex
+
+%%
+
+\s+    %empty
+
+\d+    NUMBER
+
+/lex
+
+%{
+
+using Value = int;
+
+%}
+
+%left '+'
+%left '*'
+
+%%
+
+Statements
+  : Statement             { $$ = $1 }
+  | Statements Statement  { $$ = $1 + $2 }
+  ;
+
+Statement
+  : E ';'                 { $$ = $1 }
+  | error ';'             { $$ = 0 }
+  ;
+
+E
+  : E '+' E   { $$ = $1 + $3 }
+  | E '*' E   { $$ = $1 * $3 }
+  | '(' E ')' { $$ = $2 }
+  | NUMBER    { $$ = std::stoi(std::string{$1}) }
+  ;
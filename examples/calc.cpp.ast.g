@@ -52,12 +52,14 @@ class NumericLiteral : public Node {
   int value;
 };
 
-// Type of the parsing value.
+// Type of the parsing value. The nodes are allocated in
+// the parser arena (`parser.arena()`), and are released
+// all together with it.
 using Value = Node*;
 
 
 // On parser begin hook:
-void onParseBegin(const std::string& str) {
+void onParseBegin(std::string_view str) {
   std::cout << "Parsing: " << str << "\n";
 }
 
@@ -77,13 +79,13 @@ void onParseEnd(Node* result) {
 
 E
   : E '+' E
-    { $$ = new BinaryExpression($2, $1, $3) }
+    { $$ = parser.arena().make<BinaryExpression>(std::string{$2}, $1, $3) }
 
   | E '*' E
-    { $$ = new BinaryExpression($2, $1, $3) }
+    { $$ = parser.arena().make<BinaryExpression>(std::string{$2}, $1, $3) }
 
   | '(' E ')' { $$ = $2 }
 
   | NUMBER
-    { $$ = new NumericLiteral(std::stoi($1)) }
+    { $$ = parser.arena().make<NumericLiteral>(std::stoi(std::string{$1})) }
   ;
\ No newline at end of file
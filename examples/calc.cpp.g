@@ -38,5 +38,5 @@ E
   : E '+' E   { $$ = $1 + $3 }
   | E '*' E   { $$ = $1 * $3 }
   | '(' E ')' { $$ = $2 }
-  | NUMBER    { $$ = std::stoi($1) }
+  | NUMBER    { $$ = std::stoi(std::string{$1}) }
   ;
\ No newline at end of file
@@ -0,0 +1,80 @@
+/**
+ * JSON parser in C++, counting the values of a document (based on the
+ * json.grammar.js).
+ *
+ * ./bin/syntax -g examples/json.cpp.g -m lalr1 -o JsonParser.h
+ *
+ *   #include "JsonParser.h"
+ *
+ *   JsonParser parser;
+ *
+ *   parser.parse(R"({"x": 10, "y": [true, null, "z"]})"); // 6
+ */
+
+%lex
+
+%%
+
+\s+                                                    %empty
+
+\-?(?:0|[1-9][0-9]*)(?:\.[0-9]+)?(?:[eE][-+]?[0-9]+)?  NUMBER
+
+\"(?:\\[\"\\/bfnrt]|\\u[0-9a-fA-F]{4}|[^\"\\])*\"      STRING
+
+true\b                                                 JSON_TRUE
+
+false\b                                                JSON_FALSE
+
+null\b                                                 JSON_NULL
+
+/lex
+
+%{
+
+// Number of the values in the document (an object or an array counts
+// itself, and its values). The `true`, `false`, and `null` tokens are
+// prefixed, since `NULL` (and `TRUE`, `FALSE` on some platforms) are
+// macros.
+using Value = size_t;
+
+%}
+
+%%
+
+JSONText
+  : JSONValue { $$ = $1 }
+  ;
+
+JSONValue
+  : JSON_NULL   { $$ = 1 }
+  | JSON_TRUE   { $$ = 1 }
+  | JSON_FALSE  { $$ = 1 }
+  | STRING      { $$ = 1 }
+  | NUMBER      { $$ = 1 }
+  | JSONObject  { $$ = $1 }
+  | JSONArray   { $$ = $1 }
+  ;
+
+JSONObject
+  : '{' '}'                 { $$ = 1 }
+  | '{' JSONMemberList '}'  { $$ = $2 + 1 }
+  ;
+
+JSONMemberList
+  : JSONMember                     { $$ = $1 }
+  | JSONMemberList ',' JSONMember  { $$ = $1 + $3 }
+  ;
+
+JSONMember
+  : STRING ':' JSONValue { $$ = $3 }
+  ;
+
+JSONArray
+  : '[' ']'                  { $$ = 1 }
+  | '[' JSONElementList ']'  { $$ = $2 + 1 }
+  ;
+
+JSONElementList
+  : JSONValue                      { $$ = $1 }
+  | JSONElementList ',' JSONValue  { $$ = $1 + $3 }
+  ;
@@ -0,0 +1,23 @@
+/**
+ * Test driver for the `yytext` of the handlers of a right-recursive list,
+ * parsed by the generated C++ LL(1) parser.
+ */
+
+#include <iostream>
+
+#ifndef PARSER_HEADER
+#define PARSER_HEADER "ListLL.h"
+#define PARSER_CLASS ListLL
+#endif
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+int main() {
+  PARSER_CLASS parser;
+
+  std::cout << "parse result: " << parser.parse("a, b, c, d") << "\n";
+
+  return 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * Test driver for the generated C++ LL(1) parser.
+ */
+
+#include <iostream>
+#include <sstream>
+
+#ifndef PARSER_HEADER
+#define PARSER_HEADER "CalcLL.h"
+#define PARSER_CLASS CalcLL
+#endif
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+int main() {
+  PARSER_CLASS parser;
+
+  std::cout << "parse result: " << parser.parse("2 + 2 * 2") << "\n";
+
+  std::cout << "parse result: " << parser.parse("(2 + 3) * (4 + 1) + 1")
+            << "\n";
+
+  // A long sum is parsed without the recursion on each term.
+  std::string input = "1";
+  for (auto i = 0; i < 100000; i++) {
+    input += " + 1";
+  }
+  std::cout << "parse result: " << parser.parse(input) << "\n";
+
+  std::istringstream stream("12 + 3 * (40 + 2)");
+  std::cout << "parse result: " << parser.parseStream(stream, 2) << "\n";
+
+  // The syntax error, and the number of the expected tokens for the tail
+  // after `(1 * 2`: `+`, `*`, `)`, and the end (the tail is followed by it
+  // at the top level).
+  auto result = parser.tryParse("(1 * 2 3");
+  std::cout << "parse result: " << result.ok() << " "
+            << result.error.startOffset << " "
+            << parser.expectedTokens(result.error).size() << "\n";
+
+  return 0;
+}
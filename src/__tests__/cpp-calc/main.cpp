@@ -0,0 +1,123 @@
+/**
+ * Test driver for the generated C++ calculator parser.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifndef PARSER_HEADER
+#define PARSER_HEADER "CalcParser.h"
+#define PARSER_CLASS CalcParser
+#endif
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+int main() {
+  PARSER_CLASS parser;
+
+  std::cout << "parse result: " << parser.parse("2 + 2 * 2") << "\n";
+
+  // The input is parsed in place, without copying.
+  std::string input{"(2 + 2) * 2"};
+  std::cout << "parse result: " << parser.parse(input) << "\n";
+
+  // Streaming, in small chunks.
+  std::istringstream stream{"2 * (3 + 4)"};
+  std::cout << "parse result: " << parser.parseStream(stream, 2) << "\n";
+
+  // Memory-mapped file.
+  std::ofstream{"calc-input.txt"} << "(1 + 2) * 3\n";
+  std::cout << "parse result: " << parser.parseFile("calc-input.txt") << "\n";
+  std::remove("calc-input.txt");
+
+  // A file which can't be mapped, with the error code of the system.
+  try {
+    parser.parseFile("calc-missing.txt");
+  } catch (const std::system_error& e) {
+    std::cout << "parse result: "
+              << (e.code() == std::errc::no_such_file_or_directory) << "\n";
+  }
+
+  // Independent inputs, in parallel; results are in the input order.
+  std::vector<std::string_view> inputs{"1 + 1", "2 * 3", "(4)", "5 * 5"};
+  std::cout << "parse result:";
+  for (const auto& result : parser.parseBatch(inputs, 2)) {
+    std::cout << " " << *result.value;
+  }
+  std::cout << "\n";
+
+  // Tokenized in parallel chunks, split after the "+" separators.
+  std::string large{"1 + 2 * 3 + (4 + 5) * 6 + 7"};
+  std::cout << "parse result: " << parser.parseParallel(large, "+", 3)
+            << "\n";
+
+  // The errors of the chunks are the ones of the whole string: the first in
+  // the input, and the EOF at the last match (or "!" if they differ).
+  std::cout << "parse result:";
+  for (std::string_view bad :
+       {"*+ 1 + 2 $ 3", "2 +", "1   +", "1 + 2 + ", "1 + 2 $ + 3"}) {
+    auto expected = parser.tryParse(bad).error;
+    try {
+      parser.parseParallel(bad, "+", 3);
+      std::cout << " !";
+    } catch (const SyntaxErrorException& e) {
+      auto same = e.error.kind == expected.kind &&
+                  e.error.token == expected.token &&
+                  e.error.state == expected.state &&
+                  e.error.startOffset == expected.startOffset &&
+                  e.error.endOffset == expected.endOffset;
+      if (same) {
+        std::cout << " " << e.error.startOffset;
+      } else {
+        std::cout << " !";
+      }
+    }
+  }
+  std::cout << "\n";
+
+  // Pushed input, a byte at a time: tokens split between the feeds.
+  std::string_view pushed{"12 + 3 * (40 + 2)"};
+  parser.beginPush();
+  for (auto c : pushed) {
+    parser.feed(std::string_view{&c, 1});
+  }
+  std::cout << "parse result: " << *parser.finish().value << "\n";
+
+  // Lazy tokens, stopping at the first "*".
+  parser.tokenizer.initString("2 + 3 * 4 + 5");
+  std::cout << "parse result:";
+  for (const auto& token : parser.tokenizer.tokens()) {
+    auto text = parser.tokenizer.getTokenText(token);
+    if (text == "*") {
+      break;
+    }
+    std::cout << " " << text;
+  }
+  std::cout << "\n";
+
+  // Tokens keep only the offsets; their lines and columns are located.
+  static_assert(sizeof(Token) <= 16, "Token is an offset, length, and type");
+  parser.tokenizer.initString("1 +\n  2");
+  Token last{};
+  for (const auto& token : parser.tokenizer.tokens()) {
+    last = token;
+  }
+  auto location = parser.tokenizer.locate(last.startOffset);
+  std::cout << "parse result: " << location.line << ":" << location.column
+            << "\n";
+
+  // Syntax errors as values: the expected tokens after "2 *".
+  auto parsed = parser.tryParse("2 * )");
+  std::cout << "parse result: " << parsed.ok() << " "
+            << parsed.error.startOffset << " "
+            << parser.expectedTokens(parsed.error).size() << "\n";
+
+  return 0;
+}
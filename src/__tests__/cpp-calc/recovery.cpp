@@ -0,0 +1,112 @@
+/**
+ * Test driver for the generated C++ parser with the error recovery.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define SYNTAX_PARSER_STATS 1
+
+#ifndef PARSER_HEADER
+#define PARSER_HEADER "CalcRecovery.h"
+#define PARSER_CLASS CalcRecovery
+#endif
+
+#include PARSER_HEADER
+
+using namespace syntax;
+
+int main() {
+  PARSER_CLASS parser;
+
+  // Statements with the syntax errors are skipped up to the next `;`.
+  auto result = parser.tryParse("1 + 2; 3 * * 4; 5; ) 6; 7; 8 # 9; 10;");
+
+  std::cout << "parse result: " << *result.value << "\n";
+
+  std::cout << "parse result:";
+  for (const auto& error : parser.syntaxErrors()) {
+    std::cout << " " << error.startOffset;
+  }
+  std::cout << "\n";
+
+  // Statistics of the parse: shifts, reductions by `E -> NUMBER`, tokens
+  // of the `\d+` rule, and the unexpected bytes.
+  auto stats = parser.stats();
+  std::cout << "parse result: " << stats.shifts << " "
+            << stats.reductions[8] << " "
+            << stats.tokenizer.ruleMatches[6] << " "
+            << stats.tokenizer.unexpectedInputs << "\n";
+
+  // Pushed input in chunks of 4 bytes, recovering from the errors.
+  std::string_view pushed{"1 + 2; 3 * * 4; 5; ) 6; 7; 8 # 9; 10;"};
+  parser.beginPush();
+  for (size_t i = 0; i < pushed.size(); i += 4) {
+    parser.feed(pushed.substr(i, 4));
+  }
+  auto pushedResult = parser.finish();
+  std::cout << "parse result: " << *pushedResult.value << " "
+            << parser.syntaxErrors().size() << "\n";
+
+  // A batch keeps the values of the recovered inputs, with their errors
+  // (the value, or "-", and the errors count), on the threads kept by the
+  // parser from the first batch.
+  std::vector<std::string_view> batch{"1; 2 * * 3; 4;", "5;", "6", "7; ) 8;"};
+  std::cout << "parse result:";
+  for (auto i = 0; i < 2; i++) {
+    for (const auto& batched : parser.parseBatch(batch, 2)) {
+      std::cout << " " << (batched.value ? std::to_string(*batched.value) : "-")
+                << "/" << batched.errors.size();
+    }
+  }
+  std::cout << "\n";
+
+  // Top-level statements as they are reduced, stopping after the third.
+  std::cout << "parse result:";
+  auto items = 0;
+  auto parsed = parser.parseItems(
+      "(1 + 2); 3 * 4; 5; 6;", NonTerminal::Statement, [&](Value&& item) {
+        std::cout << " " << item;
+        return ++items < 3;
+      });
+  std::cout << " " << parsed << "\n";
+
+  // Edits relex the damaged tokens, and parse again from the last checkpoint.
+  std::cout << "parse result: "
+            << *parser.tryParseEditable("1 + 2; 3 * * 4; 5;").value << " "
+            << *parser.tryReparse(Edit{9, 2, ""}).value << " "
+            << *parser.tryReparse(Edit{0, 1, "10"}).value << " "
+            << parser.editedText() << "\n";
+
+  // Edits of a text with 3 checkpoints (4000 tokens, one every 1024):
+  // before the first one, between two, across one, and after the last one,
+  // adding a syntax error, and then removing it. The value and the errors
+  // after each reparse are the ones of a full parse of the text, and the
+  // shifts (one per token) show where the parse restarts.
+  std::string statements;
+  for (auto i = 0; i < 2000; i++) {
+    statements += "1; ";
+  }
+  parser.tryParseEditable(statements);
+
+  std::cout << "parse result:";
+  for (auto edit : {Edit{300, 1, "5"}, Edit{2100, 1, "9"},
+                    Edit{3000, 600, "1 + "}, Edit{5400, 0, "* * "},
+                    Edit{5400, 4, ""}}) {
+    parser.resetStats();
+    auto reparsed = parser.tryReparse(edit);
+    auto errors = parser.syntaxErrors().size();
+    auto shifts = parser.stats().shifts;
+
+    PARSER_CLASS full;
+    auto expected = full.tryParse(parser.editedText());
+    auto same = *reparsed.value == *expected.value &&
+                errors == full.syntaxErrors().size();
+
+    std::cout << " " << *reparsed.value << (same ? "" : "!") << "/" << shifts;
+  }
+  std::cout << "\n";
+
+  return 0;
+}
@@ -0,0 +1,94 @@
+import * as shelljs from 'shelljs';
+import path from 'path';
+
+const whichCxx = shelljs.which('c++');
+const whichMake = shelljs.which('make');
+const cxxInstalled = whichCxx && whichCxx.code === 0;
+const makeInstalled = whichMake && whichMake.code === 0;
+const cppCalcDir = path.join(__dirname, 'cpp-calc');
+
+if (makeInstalled && cxxInstalled) {
+  describe('cpp plugin', () => {
+    beforeAll(() => {
+      shelljs.exec('make', {
+        cwd: cppCalcDir,
+      });
+    }, 30000);
+
+    const runCalc = binary => {
+      const runResult = shelljs.exec(`./${binary}`, {
+        silent: true,
+        cwd: cppCalcDir,
+      });
+
+      expect(runResult.code).toEqual(0);
+      expect(runResult.stderr).toEqual('');
+
+      return runResult.stdout
+        .toString('utf8')
+        .split('\n')
+        .filter(line => line.startsWith('parse result: '))
+        .map(line => line.slice('parse result: '.length));
+    };
+
+    it('calc cpp example should build, also output must match expected value', () => {
+      expect(runCalc('calc')).toEqual(['6', '8', '14', '9', '1', '2 6 4 25', '68', '0 2 4 7 6', '138', '2 + 3', '2:2', '0 4 2']);
+    });
+
+    it('calc cpp example with the DFA lexer, and in-place handler args', () => {
+      expect(runCalc('calc-dfa')).toEqual(['6', '8', '14', '9', '1', '2 6 4 25', '68', '0 2 4 7 6', '138', '2 + 3', '2:2', '0 4 2']);
+    });
+
+    it('calc cpp example with the coded driver', () => {
+      expect(runCalc('calc-coded')).toEqual(['6', '8', '14', '9', '1', '2 6 4 25', '68', '0 2 4 7 6', '138', '2 + 3', '2:2', '0 4 2']);
+    });
+
+    it('cpp error recovery, parser statistics, and reparse', () => {
+      expect(runCalc('recovery')).toEqual([
+        '25',
+        '11 19 29',
+        '16 7 10 1',
+        '25 3',
+        '5/1 5/0 -/1 7/1 5/1 5/0 -/1 7/1',
+        '3 12 5 0',
+        '8 20 29 10 + 2; 3 * 4; 5;',
+        '2004/4000 2012/2976 1813/2578 1812/529 1813/530',
+      ]);
+    });
+
+    it('cpp error recovery with the coded driver and the DFA lexer', () => {
+      expect(runCalc('recovery-coded')).toEqual([
+        '25',
+        '11 19 29',
+        '16 7 10 1',
+        '25 3',
+        '5/1 5/0 -/1 7/1 5/1 5/0 -/1 7/1',
+        '3 12 5 0',
+        '8 20 29 10 + 2; 3 * 4; 5;',
+        '2004/4000 2012/2976 1813/2578 1812/529 1813/530',
+      ]);
+    });
+
+    it('cpp LL(1) parser with the table driver', () => {
+      expect(runCalc('calc-ll')).toEqual(['6', '26', '100001', '138', '0 7 4']);
+    });
+
+    it('cpp LL(1) parser with the recursive descent, and the DFA lexer', () => {
+      expect(runCalc('calc-ll-coded')).toEqual(['6', '26', '100001', '138', '0 7 4']);
+    });
+
+    it('cpp LL(1) handlers of a right-recursive list see the yytext of their item', () => {
+      expect(runCalc('list-ll')).toEqual(['a [b] [c] [d]']);
+      expect(runCalc('list-ll-coded')).toEqual(['a [b] [c] [d]']);
+    });
+  });
+} else {
+  describe('cpp plugin mock', () => {
+    it('noop', () => {
+      console.warn(
+        'make and a C++17 compiler (c++) are not installed.',
+        'Tests for cpp plugin will be skipped.'
+      );
+    });
+  });
+}
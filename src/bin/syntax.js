@@ -125,6 +125,26 @@ const options = require('nomnom')
       help: 'Append a wrapping namespace to generated code',
       type: 'string',
     },
+    lexer: {
+      help:
+        'Lexer of the generated parser: regex (default), or dfa ' +
+        '(compiles all lex rules into one DFA, C++ plugin)',
+      type: 'string',
+    },
+    'handler-args': {
+      help:
+        'How production handlers take the arguments: pop (default, moves ' +
+        'them off the stack), or inplace (refers to them on the stack, ' +
+        'which is truncated after the action), C++ plugin',
+      type: 'string',
+    },
+    driver: {
+      help:
+        'Driver of the generated parser: table (default, interprets ' +
+        'the parsing table), or coded (compiles the LR automaton into ' +
+        'code, or the LL grammar into a recursive descent), C++ plugin',
+      type: 'string',
+    },
   })
   .parse();
 
@@ -151,6 +171,9 @@ const generatorOptions = {
   customTokenizer: options['custom-tokenizer'],
   resolveConflicts: options['resolve-conflicts'],
   namespace: options['namespace'],
+  lexer: options.lexer,
+  handlerArgs: options['handler-args'],
+  driver: options.driver,
 };
 
 /**
@@ -415,6 +438,8 @@ const parsers = {
   },
 
   LL1(options) {
+    global.globalOptions.output = options.output;
+
     const grammar = getGrammar(options.grammar, GRAMMAR_MODE.LL1);
 
     console.info(`\nParsing mode: ${grammar.getMode()}.`);
@@ -463,6 +488,9 @@ const parsers = {
           .default,
         rb: require(ROOT + 'plugins/ruby/ll/ll-parser-generator-ruby.js')
           .default,
+        h: require(ROOT + 'plugins/cpp/ll/ll-parser-generator-cpp.js').default,
+        cpp: require(ROOT + 'plugins/cpp/ll/ll-parser-generator-cpp.js')
+          .default,
       };
 
       const LLParserGenerator = GENERATORS[language];
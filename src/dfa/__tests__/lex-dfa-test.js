@@ -0,0 +1,148 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2015-present Dmitry Soshnikov <dmitry.soshnikov@gmail.com>
+ */
+
+import LexDFA from '../lex-dfa';
+import LexGrammar from '../../grammar/lex-grammar';
+
+function dfaFor(rules, options = {}) {
+  return LexDFA.fromLexGrammar(new LexGrammar({rules, options}));
+}
+
+describe('lex-dfa', () => {
+  it('matches character classes and quantifiers', () => {
+    const dfa = dfaFor([
+      ['\\s+', '/* skip */'],
+      ['\\d+(\\.\\d+)?', 'return "NUMBER"'],
+      ['[a-zA-Z_][\\w$]*', 'return "ID"'],
+      ['"[^"]*"', 'return "STRING"'],
+      ['x{2,3}', 'return "XS"'],
+    ]);
+
+    expect(dfa.match('   x')).toEqual({rule: 0, length: 3});
+    expect(dfa.match('3.14 ')).toEqual({rule: 1, length: 4});
+    expect(dfa.match('3. ')).toEqual({rule: 1, length: 1});
+    expect(dfa.match('foo$1+')).toEqual({rule: 2, length: 5});
+    expect(dfa.match('"a b" c')).toEqual({rule: 3, length: 5});
+    expect(dfa.match('"a b')).toBe(null);
+    expect(dfa.match('+')).toBe(null);
+  });
+
+  it('prefers the first rule that matches', () => {
+    const dfa = dfaFor([
+      ['if', 'return "IF"'],
+      ['\\w+', 'return "ID"'],
+      ['=', 'return "="'],
+      ['==', 'return "=="'],
+    ]);
+
+    // As with the regexp tokenizer, the first matching rule wins,
+    // even if a later rule matches a longer string.
+    expect(dfa.match('iffy')).toEqual({rule: 0, length: 2});
+    expect(dfa.match('ify')).toEqual({rule: 0, length: 2});
+    expect(dfa.match('fif')).toEqual({rule: 1, length: 3});
+    expect(dfa.match('==')).toEqual({rule: 2, length: 1});
+  });
+
+  it('supports word boundaries and end of input', () => {
+    const dfa = dfaFor([
+      ['\\bif\\b', 'return "IF"'],
+      ['\\w+', 'return "ID"'],
+      ['<<EOF>>', 'return "$"'],
+    ]);
+
+    expect(dfa.match('if (')).toEqual({rule: 0, length: 2});
+    expect(dfa.match('if')).toEqual({rule: 0, length: 2});
+    expect(dfa.match('iffy')).toEqual({rule: 1, length: 4});
+    expect(dfa.match('')).toEqual({rule: 2, length: 0});
+  });
+
+  it('supports start conditions', () => {
+    const dfa = LexDFA.fromLexGrammar(
+      new LexGrammar({
+        startConditions: {comment: 1},
+        rules: [
+          ['\\/\\*', 'this.begin("comment");'],
+          [['comment'], '\\*\\/', 'this.popState();'],
+          [['comment'], '[^*]+|\\*', '/* skip */'],
+          ['\\w+', 'return "ID"'],
+        ],
+      })
+    );
+
+    expect(dfa.getConditions()).toEqual(['INITIAL', 'comment']);
+
+    expect(dfa.match('/* a */', 'INITIAL')).toEqual({rule: 0, length: 2});
+    expect(dfa.match('foo', 'INITIAL')).toEqual({rule: 3, length: 3});
+    expect(dfa.match('foo', 'comment')).toEqual({rule: 2, length: 3});
+    expect(dfa.match('*/', 'comment')).toEqual({rule: 1, length: 2});
+  });
+
+  it('supports case-insensitive rules', () => {
+    const dfa = dfaFor([['select', 'return "SELECT"']], {
+      'case-insensitive': true,
+    });
+
+    expect(dfa.match('SeLeCt')).toEqual({rule: 0, length: 6});
+  });
+
+  it('minimizes states', () => {
+    const dfa = dfaFor([['a+|aa+|aaa+', 'return "A"']]);
+
+    // Dead state, start state, and the accepting loop.
+    expect(dfa.getStatesCount()).toBe(3);
+    expect(dfa.getTransitions().length).toBe(3 * dfa.getClassesCount());
+  });
+
+  it('rejects rules which the regexp lexer matches shorter', () => {
+    // The regexp lexer takes the first match in the backtracking order
+    // (of the alternations, and the greedy quantifiers), the DFA the
+    // longest match.
+    expect(/^(?:a|ab)/.exec('ab')[0].length).toBe(1);
+    expect(() => dfaFor([['a|ab', 'return "A"']])).toThrow(
+      /on "ab" the regexp lexer matches "a"/
+    );
+    expect(() => dfaFor([['\\d+|\\d+\\.\\d+', 'return "N"']])).toThrow();
+    expect(() => dfaFor([['x(y|yz)*', 'return "X"']])).toThrow();
+
+    // The optional and repeated sub-patterns, followed by a longer one.
+    [
+      ['(ab)?(abcd)?', 'abcd', 2],
+      ['a(bc)?(bcd)?', 'abcd', 3],
+      ['(xy)*(xyz)?', 'xyz', 2],
+    ].forEach(([source, input, length]) => {
+      expect(new RegExp(`^(?:${source})`).exec(input)[0].length).toBe(length);
+      expect(() => dfaFor([[source, 'return "A"']])).toThrow(
+        `on "${input}" the regexp lexer matches "${input.slice(0, length)}"`
+      );
+    });
+
+    // With the longer branch first, or a branch not extending an earlier
+    // one, both lexers match the same.
+    const rules = [
+      ['ab|a', 'return "A"'],
+      ['\\d+(\\.\\d+)?|\\.\\d+', 'return "N"'],
+      ['c+|cc+', 'return "C"'],
+      ['x(yz)?(y)?', 'return "X"'],
+      ['[a-z]+(_[a-z]+)*', 'return "W"'],
+    ];
+    const dfa = dfaFor(rules);
+
+    const inputs = ['ab', 'ac', '3.14', '3.', '.5', 'ccc', 'xyz', 'xy', 'd_e_'];
+    inputs.forEach(input => {
+      const index = rules.findIndex(([source]) =>
+        new RegExp(`^(?:${source})`).test(input)
+      );
+      const length = new RegExp(`^(?:${rules[index][0]})`).exec(input)[0]
+        .length;
+      expect(dfa.match(input)).toEqual({rule: index, length});
+    });
+  });
+
+    it('rejects constructs which need backtracking', () => {
+    expect(() => dfaFor([['a(?=b)', 'return "A"']])).toThrow();
+    expect(() => dfaFor([['(a)\\1', 'return "A"']])).toThrow();
+    expect(() => dfaFor([['a+?', 'return "A"']])).toThrow();
+  });
+});
@@ -0,0 +1,76 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2015-present Dmitry Soshnikov <dmitry.soshnikov@gmail.com>
+ */
+
+import RegExpParser from '../regexp-parser';
+
+function firstBytesOf(source, options) {
+  const {bytes, nullable} = RegExpParser.firstBytes(
+    RegExpParser.parse(source, options)
+  );
+  return {
+    chars: bytes
+      .map((included, b) => (included ? String.fromCharCode(b) : ''))
+      .join(''),
+    nullable,
+  };
+}
+
+describe('regexp-parser', () => {
+  it('first bytes', () => {
+    expect(firstBytesOf('\\d+')).toEqual({chars: '0123456789', nullable: false});
+    expect(firstBytesOf('a?b|c*')).toEqual({chars: 'abc', nullable: true});
+    expect(firstBytesOf('(?:x|y)z')).toEqual({chars: 'xy', nullable: false});
+    expect(firstBytesOf('\\bif\\b')).toEqual({chars: 'i', nullable: false});
+    expect(firstBytesOf('$')).toEqual({chars: '', nullable: true});
+    expect(firstBytesOf('k', {caseInsensitive: true})).toEqual({
+      chars: 'Kk',
+      nullable: false,
+    });
+  });
+
+  it('shapes', () => {
+    const shapeOf = source => {
+      const shape = RegExpParser.shape(RegExpParser.parse(source));
+      if (!shape || shape.kind === 'literal' || shape.kind === 'keyword') {
+        return shape;
+      }
+      if (shape.kind === 'set') {
+        return {kind: 'set', first: RegExpParser.byteRanges(shape.first)};
+      }
+      return {
+        kind: shape.kind,
+        first: RegExpParser.byteRanges(shape.first),
+        rest: RegExpParser.byteRanges(shape.rest),
+      };
+    };
+
+    expect(shapeOf('\\+')).toEqual({kind: 'literal', bytes: [0x2b]});
+    expect(shapeOf('if')).toEqual({kind: 'literal', bytes: [0x69, 0x66]});
+    expect(shapeOf('^if')).toEqual({kind: 'literal', bytes: [0x69, 0x66]});
+    expect(shapeOf('\\s+')).toEqual({
+      kind: 'run',
+      first: [[0x09, 0x0d], [0x20, 0x20]],
+      rest: [[0x09, 0x0d], [0x20, 0x20]],
+    });
+    expect(shapeOf('[a-z_]\\w*')).toEqual({
+      kind: 'run',
+      first: [[0x5f, 0x5f], [0x61, 0x7a]],
+      rest: [[0x30, 0x39], [0x41, 0x5a], [0x5f, 0x5f], [0x61, 0x7a]],
+    });
+    expect(shapeOf('[()]')).toEqual({kind: 'set', first: [[0x28, 0x29]]});
+    expect(shapeOf('\\d+\\.\\d+')).toEqual(null);
+    expect(shapeOf('\\bif\\b')).toEqual({kind: 'keyword', bytes: [0x69, 0x66]});
+    expect(shapeOf('do\\b')).toEqual({kind: 'keyword', bytes: [0x64, 0x6f]});
+    expect(shapeOf('\\b\\+\\b')).toEqual(null);
+    expect(shapeOf('\\bif')).toEqual(null);
+    expect(shapeOf('a*')).toEqual(null);
+  });
+
+  it('rejects constructs which are not regular', () => {
+    expect(() => RegExpParser.parse('(?=a)')).toThrow(/lookaround/);
+    expect(() => RegExpParser.parse('(a)\\1')).toThrow(/backreferences/);
+    expect(() => RegExpParser.parse('a+?')).toThrow(/lazy/);
+  });
+});
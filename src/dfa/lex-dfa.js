@@ -0,0 +1,757 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2015-present Dmitry Soshnikov <dmitry.soshnikov@gmail.com>
+ */
+
+import RegExpParser from './regexp-parser';
+
+/**
+ * Kinds of the position after a matched prefix. Accepting rules of a DFA
+ * state may depend on it because of the `\b`, `\B`, and `$` assertions.
+ */
+const NEXT_NON_WORD = 0;
+const NEXT_WORD = 1;
+const NEXT_END = 2;
+
+const NEXT_KINDS_COUNT = 3;
+
+/**
+ * No accepting rule.
+ */
+const NO_RULE = -1;
+
+/**
+ * Max number of the explored states when comparing the matches of a rule
+ * in the regexp lexer and in the DFA (the lex rules are small).
+ */
+const MAX_PRIORITY_STATES = 10000;
+
+/**
+ * Compiles an AST node into a standalone NFA, `{states, start, accept}`,
+ * with the assertions as the epsilon moves (which over-approximates the
+ * matched strings). The epsilon moves of a state are ordered by the
+ * priority of a backtracking regexp engine: the branches of an alternation
+ * in order, and the greedy quantifiers trying one more repetition before
+ * leaving the loop.
+ */
+function priorityNFA(node) {
+  const states = [];
+  const newState = () => states.push({eps: [], edges: []}) - 1;
+
+  const compile = (node, from) => {
+    switch (node.type) {
+      case 'empty':
+        return from;
+
+      case 'set': {
+        const to = newState();
+        states[from].edges.push({bytes: node.bytes, to});
+        return to;
+      }
+
+      case 'assert': {
+        const to = newState();
+        states[from].eps.push(to);
+        return to;
+      }
+
+      case 'seq':
+        return node.items.reduce((state, item) => compile(item, state), from);
+
+      case 'alt': {
+        const end = newState();
+        node.items.forEach(item => {
+          const start = newState();
+          states[from].eps.push(start);
+          states[compile(item, start)].eps.push(end);
+        });
+        return end;
+      }
+
+      case 'repeat': {
+        let state = from;
+        for (let i = 0; i < node.min; i++) {
+          state = compile(node.node, state);
+        }
+        const end = newState();
+        if (node.max === Infinity) {
+          const loop = newState();
+          const body = newState();
+          states[state].eps.push(loop);
+          states[loop].eps.push(body);
+          states[compile(node.node, body)].eps.push(loop);
+          states[loop].eps.push(end);
+          return end;
+        }
+        for (let i = node.min; i < node.max; i++) {
+          const body = newState();
+          states[state].eps.push(body);
+          states[state].eps.push(end);
+          state = compile(node.node, body);
+        }
+        states[state].eps.push(end);
+        return end;
+      }
+
+      default:
+        throw new Error(`Unexpected regexp node: ${node.type}`);
+    }
+  };
+
+  const start = newState();
+  const accept = compile(node, start);
+  return {states, start, accept};
+}
+
+/**
+ * Threads of a backtracking match after the NFA states, in the order of
+ * their priority: the states with the byte moves, and the accepting one.
+ * The threads after an accepting one can't win any more, so they are cut,
+ * as in a Pike VM (unless `cut` is false).
+ */
+function priorityClosure(nfa, states, cut = true) {
+  const threads = [];
+  const visited = new Set();
+
+  const visit = state => {
+    if (visited.has(state)) {
+      return;
+    }
+    visited.add(state);
+    if (nfa.states[state].edges.length > 0 || state === nfa.accept) {
+      threads.push(state);
+    }
+    nfa.states[state].eps.forEach(visit);
+  };
+  states.forEach(visit);
+
+  const accepted = threads.indexOf(nfa.accept);
+  return !cut || accepted === -1 ? threads : threads.slice(0, accepted + 1);
+}
+
+/**
+ * States after the byte `b`, in the order of the threads.
+ */
+function priorityStep(nfa, threads, b) {
+  const moved = [];
+  threads.forEach(state => {
+    nfa.states[state].edges.forEach(edge => {
+      if (edge.bytes[b]) {
+        moved.push(edge.to);
+      }
+    });
+  });
+  return moved;
+}
+
+/**
+ * Representative bytes of the classes of the bytes, which all the sets of
+ * the AST treat the same (a printable one if any).
+ */
+function representativeBytes(node) {
+  const sets = [];
+  const collect = node => {
+    if (node.type === 'set') {
+      sets.push(node.bytes);
+    } else if (node.items) {
+      node.items.forEach(collect);
+    } else if (node.node) {
+      collect(node.node);
+    }
+  };
+  collect(node);
+
+  const classes = new Map();
+  for (let b = 0; b < 256; b++) {
+    const signature = sets.map(bytes => (bytes[b] ? '1' : '0')).join('');
+    const printable = b >= 0x20 && b < 0x7f;
+    if (!classes.has(signature) ||
+        (printable && !classes.get(signature).printable)) {
+      classes.set(signature, {byte: b, printable});
+    }
+  }
+  return Array.from(classes.values()).map(({byte}) => byte);
+}
+
+/**
+ * Finds a string on which a regexp engine with the backtracking semantics
+ * (ECMAScript, `std::regex`) matches a rule shorter than its longest
+ * match, taken by the DFA: e.g. `a|ab`, or `(ab)?(abcd)?` on `abcd`.
+ * Returns `{input, matched}` (the input is the longest match, and the
+ * `matched` the length of the regexp one), or null.
+ *
+ * Explores the pairs of the prioritized threads of the backtracking match
+ * (`priorityClosure`), and all the NFA states of the DFA. They disagree on
+ * a string iff the DFA accepts after it, and the cut threads don't: the
+ * regexp match then ended earlier.
+ */
+function findShorterMatch(node) {
+  const nfa = priorityNFA(node);
+  const bytes = representativeBytes(node);
+
+  const accepts = threads => threads[threads.length - 1] === nfa.accept;
+
+  const initial = priorityClosure(nfa, [nfa.start]);
+  const queue = [{
+    threads: initial,
+    all: priorityClosure(nfa, [nfa.start], /* cut */ false),
+    input: [],
+    matched: accepts(initial) ? 0 : -1,
+  }];
+  const visited = new Set();
+
+  while (queue.length > 0) {
+    const {threads, all, input, matched} = queue.shift();
+    const key = `${threads}|${all.slice().sort((a, b) => a - b)}`;
+
+    if (visited.has(key)) {
+      continue;
+    }
+    visited.add(key);
+
+    if (visited.size > MAX_PRIORITY_STATES) {
+      throw new Error(
+        'is too complex to check that the regexp lexer and the DFA match ' +
+          'the same'
+      );
+    }
+
+    if (all.includes(nfa.accept) && !accepts(threads)) {
+      return {input: Buffer.from(input).toString('latin1'), matched};
+    }
+
+    for (const byte of bytes) {
+      // All the states of the DFA, without the priority cut.
+      const nextAll = priorityClosure(
+        nfa,
+        priorityStep(nfa, all, byte),
+        /* cut */ false
+      );
+
+      if (nextAll.length === 0) {
+        continue;
+      }
+
+      const nextThreads =
+        priorityClosure(nfa, priorityStep(nfa, threads, byte));
+
+      queue.push({
+        threads: nextThreads,
+        all: nextAll,
+        input: [...input, byte],
+        matched: accepts(nextThreads) ? input.length + 1 : matched,
+      });
+    }
+  }
+
+  return null;
+}
+
+/**
+ * Minimized DFA built from all lex rules of a lexical grammar.
+ *
+ * All rules of each start condition are compiled into one automaton, which
+ * emulates the tokenizer's rule priority: among all rules matching at the
+ * cursor, the one defined first wins (with its longest match). Each DFA state
+ * therefore stores the smallest accepting rule index.
+ *
+ * The automaton runs over bytes, which are grouped into equivalence classes.
+ * The tables are:
+ *
+ *   - classes: byte -> class
+ *   - classKinds: class -> NEXT_WORD, or NEXT_NON_WORD
+ *   - transitions: state * classesCount + class -> state (0 is dead)
+ *   - accepts: state * 3 + next kind -> rule index, or -1
+ *   - startStates: start condition index -> state
+ */
+export default class LexDFA {
+  /**
+   * Rules are `{source, caseInsensitive}` objects (regexp sources include
+   * the leading `^` anchor), and `conditions` is a map from a start
+   * condition to the list of its rule indices.
+   */
+  constructor({rules, conditions}) {
+    this._conditions = Object.keys(conditions);
+
+    this._buildNFA(rules, conditions);
+    this._buildClasses();
+    this._buildDFA();
+    this._minimize();
+  }
+
+  /**
+   * Builds the DFA for all rules of a lexical grammar.
+   */
+  static fromLexGrammar(lexGrammar) {
+    const rulesByConditions = lexGrammar.getRulesByStartConditions();
+    const conditions = {};
+
+    for (const condition in rulesByConditions) {
+      conditions[condition] = rulesByConditions[condition].map(lexRule =>
+        lexGrammar.getRuleIndex(lexRule)
+      );
+    }
+
+    return new LexDFA({
+      rules: lexGrammar.getRules().map(lexRule => ({
+        source: lexRule.getRawMatcher(),
+        caseInsensitive: lexRule.isCaseInsensitive(),
+      })),
+      conditions,
+    });
+  }
+
+  /**
+   * Start condition names, in order of the start states.
+   */
+  getConditions() {
+    return this._conditions;
+  }
+
+  getClasses() {
+    return this._classes;
+  }
+
+  getClassesCount() {
+    return this._classesCount;
+  }
+
+  getClassKinds() {
+    return this._classKinds;
+  }
+
+  getStatesCount() {
+    return this._statesCount;
+  }
+
+  getTransitions() {
+    return this._transitions;
+  }
+
+  getAccepts() {
+    return this._accepts;
+  }
+
+  getStartStates() {
+    return this._startStates;
+  }
+
+  /**
+   * Matches a string at the cursor the same way the generated tokenizer
+   * does. Returns `{rule, length}` (length in bytes), or `null`.
+   */
+  match(string, condition = 'INITIAL', cursor = 0) {
+    const bytes = Buffer.from(string, 'utf8');
+
+    let state = this._startStates[this._conditions.indexOf(condition)];
+    let rule = NO_RULE;
+    let length = 0;
+
+    for (let p = cursor; ; p++) {
+      const atEnd = p === bytes.length;
+      const next = atEnd ? NEXT_END : this._classKinds[this._classes[bytes[p]]];
+      const accept = this._accepts[state * NEXT_KINDS_COUNT + next];
+
+      if (accept !== NO_RULE && (rule === NO_RULE || accept <= rule)) {
+        rule = accept;
+        length = p - cursor;
+      }
+
+      if (atEnd) {
+        break;
+      }
+
+      state = this._transitions[
+        state * this._classesCount + this._classes[bytes[p]]
+      ];
+
+      if (state === 0) {
+        break;
+      }
+    }
+
+    return rule === NO_RULE ? null : {rule, length};
+  }
+
+  // ------------------------------------------------------------------
+  // NFA (Thompson's construction).
+
+  _buildNFA(rules, conditions) {
+    this._nfa = [];
+    this._sets = [];
+    this._setIds = new Map();
+
+    const ruleStarts = rules.map((rule, index) => {
+      let ast;
+
+      try {
+        ast = RegExpParser.parse(rule.source, {
+          caseInsensitive: rule.caseInsensitive,
+        });
+      } catch (e) {
+        throw new Error(
+          `Lex rule ${index + 1} can't be compiled into a DFA: ${e.message}`
+        );
+      }
+
+      // The DFA takes the longest match of a rule, and the regexp lexer
+      // the first match in the backtracking order (of the alternations and
+      // the greedy quantifiers), so the rules on which they would differ
+      // are rejected.
+      let shorter;
+      try {
+        shorter = findShorterMatch(ast);
+      } catch (e) {
+        throw new Error(
+          `Lex rule ${index + 1} can't be compiled into a DFA: ${e.message}`
+        );
+      }
+      if (shorter) {
+        throw new Error(
+          `Lex rule ${index + 1} can't be compiled into a DFA: on ` +
+            `${JSON.stringify(shorter.input)} the regexp lexer matches ` +
+            `${JSON.stringify(shorter.input.slice(0, shorter.matched))}, ` +
+            `and the DFA the longest match (put the longer alternatives ` +
+            `first)`
+        );
+      }
+
+      const start = this._newNFAState();
+      this._nfa[this._compile(ast, start)].accept = index;
+      return start;
+    });
+
+    this._nfaStarts = this._conditions.map(condition =>
+      conditions[condition].map(ruleIndex => ruleStarts[ruleIndex])
+    );
+  }
+
+  _newNFAState() {
+    this._nfa.push({eps: [], asserts: [], edges: [], accept: NO_RULE});
+    return this._nfa.length - 1;
+  }
+
+  _internSet(bytes) {
+    const key = bytes.map(Number).join('');
+    if (!this._setIds.has(key)) {
+      this._setIds.set(key, this._sets.length);
+      this._sets.push(bytes);
+    }
+    return this._setIds.get(key);
+  }
+
+  /**
+   * Compiles an AST node starting from the `from` state, returns
+   * the end state.
+   */
+  _compile(node, from) {
+    switch (node.type) {
+      case 'empty':
+        return from;
+
+      case 'set': {
+        const to = this._newNFAState();
+        this._nfa[from].edges.push({set: this._internSet(node.bytes), to});
+        return to;
+      }
+
+      case 'assert': {
+        const to = this._newNFAState();
+        this._nfa[from].asserts.push({kind: node.kind, to});
+        return to;
+      }
+
+      case 'seq':
+        return node.items.reduce((state, item) => this._compile(item, state), from);
+
+      case 'alt': {
+        const end = this._newNFAState();
+        node.items.forEach(item => {
+          const start = this._newNFAState();
+          this._nfa[from].eps.push(start);
+          this._nfa[this._compile(item, start)].eps.push(end);
+        });
+        return end;
+      }
+
+      case 'repeat': {
+        let state = from;
+
+        for (let i = 0; i < node.min; i++) {
+          state = this._compile(node.node, state);
+        }
+
+        if (node.max === Infinity) {
+          const loop = this._newNFAState();
+          this._nfa[state].eps.push(loop);
+          this._nfa[this._compile(node.node, loop)].eps.push(loop);
+          return loop;
+        }
+
+        const end = this._newNFAState();
+        for (let i = node.min; i < node.max; i++) {
+          this._nfa[state].eps.push(end);
+          state = this._compile(node.node, state);
+        }
+        this._nfa[state].eps.push(end);
+        return end;
+      }
+
+      default:
+        throw new Error(`Unexpected regexp node: ${node.type}`);
+    }
+  }
+
+  // ------------------------------------------------------------------
+  // Byte classes.
+
+  /**
+   * Groups bytes which behave the same in all transitions (and are of the
+   * same word kind for `\b` assertions) into classes.
+   */
+  _buildClasses() {
+    const classIds = new Map();
+
+    this._classes = [];
+    this._classKinds = [];
+    this._classBytes = [];
+
+    for (let b = 0; b < 256; b++) {
+      const kind = RegExpParser.isWordByte(b) ? NEXT_WORD : NEXT_NON_WORD;
+      const signature =
+        kind + this._sets.map(bytes => (bytes[b] ? '1' : '0')).join('');
+
+      if (!classIds.has(signature)) {
+        classIds.set(signature, this._classKinds.length);
+        this._classKinds.push(kind);
+        this._classBytes.push(b);
+      }
+
+      this._classes.push(classIds.get(signature));
+    }
+
+    this._classesCount = this._classKinds.length;
+  }
+
+  // ------------------------------------------------------------------
+  // DFA (subset construction).
+
+  /**
+   * Whether an assertion holds in the context.
+   */
+  _assertionHolds(kind, context) {
+    const nextIsWord = context.next === NEXT_WORD;
+
+    switch (kind) {
+      case 'bol':
+        return context.atStart;
+      case 'eol':
+        return context.next === NEXT_END;
+      case 'wordBoundary':
+        return context.prevWord !== nextIsWord;
+      case 'notWordBoundary':
+        return context.prevWord === nextIsWord;
+      default:
+        throw new Error(`Unexpected assertion: ${kind}`);
+    }
+  }
+
+  /**
+   * Epsilon closure of a set of NFA states. If the context is passed,
+   * also follows the assertions which hold in it.
+   */
+  _closure(states, context = null) {
+    const result = new Set(states);
+    const stack = [...states];
+
+    while (stack.length > 0) {
+      const state = this._nfa[stack.pop()];
+      const targets = state.eps.slice();
+
+      if (context) {
+        state.asserts.forEach(({kind, to}) => {
+          if (this._assertionHolds(kind, context)) {
+            targets.push(to);
+          }
+        });
+      }
+
+      targets.forEach(to => {
+        if (!result.has(to)) {
+          result.add(to);
+          stack.push(to);
+        }
+      });
+    }
+
+    return result;
+  }
+
+  _getDFAState(nfaStates, prevWord, atStart) {
+    const set = Array.from(this._closure(nfaStates)).sort((a, b) => a - b);
+
+    // All empty sets are the dead state.
+    const key = set.length === 0 ? 'dead' : `${+prevWord}${+atStart}:${set}`;
+
+    if (!this._dfaIds.has(key)) {
+      this._dfaIds.set(key, this._dfa.length);
+      this._dfa.push({set, prevWord, atStart});
+    }
+
+    return this._dfaIds.get(key);
+  }
+
+  _buildDFA() {
+    this._dfa = [];
+    this._dfaIds = new Map();
+
+    // Dead state is always 0.
+    this._getDFAState([], false, false);
+
+    // The tokenizer matches from the cursor as from the beginning of
+    // the string, so the previous character is always a non-word one.
+    const starts = this._nfaStarts.map(states =>
+      this._getDFAState(states, false, true)
+    );
+
+    this._dfaTransitions = [];
+    this._dfaAccepts = [];
+
+    for (let id = 0; id < this._dfa.length; id++) {
+      const {set, prevWord, atStart} = this._dfa[id];
+      const context = next => ({atStart, prevWord, next});
+
+      for (let next = 0; next < NEXT_KINDS_COUNT; next++) {
+        let accept = NO_RULE;
+        this._closure(set, context(next)).forEach(state => {
+          const rule = this._nfa[state].accept;
+          if (rule !== NO_RULE && (accept === NO_RULE || rule < accept)) {
+            accept = rule;
+          }
+        });
+        this._dfaAccepts[id * NEXT_KINDS_COUNT + next] = accept;
+      }
+
+      const resolved = [null, null];
+
+      for (let c = 0; c < this._classesCount; c++) {
+        const b = this._classBytes[c];
+        const kind = this._classKinds[c];
+
+        if (!resolved[kind]) {
+          resolved[kind] = this._closure(set, context(kind));
+        }
+
+        const moved = [];
+        resolved[kind].forEach(state => {
+          this._nfa[state].edges.forEach(edge => {
+            if (this._sets[edge.set][b]) {
+              moved.push(edge.to);
+            }
+          });
+        });
+
+        this._dfaTransitions[id * this._classesCount + c] = this._getDFAState(
+          moved,
+          kind === NEXT_WORD,
+          false
+        );
+      }
+    }
+
+    this._dfaStarts = starts;
+  }
+
+  // ------------------------------------------------------------------
+  // Minimization (Moore's partition refinement).
+
+  _minimize() {
+    const count = this._dfa.length;
+    const classesCount = this._classesCount;
+
+    const accepts = id =>
+      this._dfaAccepts.slice(
+        id * NEXT_KINDS_COUNT,
+        (id + 1) * NEXT_KINDS_COUNT
+      );
+
+    // Initial partition by accepting rules.
+    let blocks = this._partition(count, id => accepts(id).join(','));
+    let blocksCount = new Set(blocks).size;
+
+    for (;;) {
+      const current = blocks;
+      const refined = this._partition(count, id => {
+        const targets = [current[id]];
+        for (let c = 0; c < classesCount; c++) {
+          targets.push(current[this._dfaTransitions[id * classesCount + c]]);
+        }
+        return targets.join(',');
+      });
+      const refinedCount = new Set(refined).size;
+
+      blocks = refined;
+
+      if (refinedCount === blocksCount) {
+        break;
+      }
+
+      blocksCount = refinedCount;
+    }
+
+    // Renumber in BFS order from the start states, with the dead block as 0.
+    const numbers = new Map([[blocks[0], 0]]);
+    const representatives = [0];
+    const queue = [];
+
+    const number = id => {
+      if (!numbers.has(blocks[id])) {
+        numbers.set(blocks[id], representatives.length);
+        representatives.push(id);
+        queue.push(id);
+      }
+      return numbers.get(blocks[id]);
+    };
+
+    this._startStates = this._dfaStarts.map(number);
+
+    while (queue.length > 0) {
+      const id = queue.shift();
+      for (let c = 0; c < classesCount; c++) {
+        number(this._dfaTransitions[id * classesCount + c]);
+      }
+    }
+
+    this._statesCount = representatives.length;
+    this._transitions = [];
+    this._accepts = [];
+
+    representatives.forEach(id => {
+      for (let c = 0; c < classesCount; c++) {
+        this._transitions.push(
+          numbers.get(blocks[this._dfaTransitions[id * classesCount + c]])
+        );
+      }
+      this._accepts.push(...accepts(id));
+    });
+  }
+
+  /**
+   * Assigns block numbers to states by a key function.
+   */
+  _partition(count, keyOf) {
+    const ids = new Map();
+    const blocks = [];
+    for (let id = 0; id < count; id++) {
+      const key = keyOf(id);
+      if (!ids.has(key)) {
+        ids.set(key, ids.size);
+      }
+      blocks.push(ids.get(key));
+    }
+    return blocks;
+  }
+}
+
+LexDFA.NO_RULE = NO_RULE;
+LexDFA.NEXT_KINDS_COUNT = NEXT_KINDS_COUNT;
@@ -0,0 +1,636 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2015-present Dmitry Soshnikov <dmitry.soshnikov@gmail.com>
+ */
+
+/**
+ * Parser of the regexp subset which can be compiled into a DFA.
+ *
+ * Parses the ECMAScript regexp syntax used in lex rules into an AST, which
+ * operates on bytes (the generated tokenizers match over `char` buffers),
+ * i.e. non-ASCII characters are encoded as UTF-8 sequences.
+ *
+ * AST nodes:
+ *
+ *   {type: 'empty'}
+ *   {type: 'set', bytes: [256 booleans]}   -- matches one byte
+ *   {type: 'seq', items: [...]}
+ *   {type: 'alt', items: [...]}
+ *   {type: 'repeat', node, min, max}       -- max is Infinity if unbounded
+ *   {type: 'assert', kind}                 -- bol, eol, wordBoundary,
+ *                                             notWordBoundary
+ *
+ * Constructs which can't be expressed by a DFA (backreferences, lookaround,
+ * lazy quantifiers) throw an error.
+ */
+
+/**
+ * Max repetition count in the `{n,m}` quantifiers.
+ */
+const MAX_REPEAT = 1000;
+
+/**
+ * Creates a byte set from a predicate.
+ */
+function byteSet(predicate = () => false) {
+  const bytes = new Array(256);
+  for (let i = 0; i < 256; i++) {
+    bytes[i] = !!predicate(i);
+  }
+  return bytes;
+}
+
+const isDigit = c => c >= 0x30 && c <= 0x39;
+const isUpper = c => c >= 0x41 && c <= 0x5a;
+const isLower = c => c >= 0x61 && c <= 0x7a;
+
+/**
+ * Bytes matched by `\w` (also used for `\b` assertions).
+ */
+const isWordByte = c => isDigit(c) || isUpper(c) || isLower(c) || c === 0x5f;
+
+/**
+ * Bytes matched by `\s` in the C++ `std::regex` (the "C" locale `isspace`).
+ */
+const isSpaceByte = c => c === 0x20 || (c >= 0x09 && c <= 0x0d);
+
+/**
+ * Bytes matched by `.` (everything except line terminators).
+ */
+const isDotByte = c => c !== 0x0a && c !== 0x0d;
+
+/**
+ * Encodes a code point as UTF-8 bytes.
+ */
+function toUTF8(codePoint) {
+  return Array.from(Buffer.from(String.fromCodePoint(codePoint), 'utf8'));
+}
+
+class RegExpParser {
+  constructor(source, {caseInsensitive = false} = {}) {
+    this._source = source;
+    this._caseInsensitive = caseInsensitive;
+    this._pos = 0;
+  }
+
+  /**
+   * Parses the whole regexp.
+   */
+  parse() {
+    const node = this._parseAlternation();
+    if (this._pos < this._source.length) {
+      this._error(`unexpected "${this._source[this._pos]}"`);
+    }
+    return node;
+  }
+
+  _error(message) {
+    throw new SyntaxError(
+      `/${this._source}/: ${message} at position ${this._pos}`
+    );
+  }
+
+  _peek(offset = 0) {
+    return this._source[this._pos + offset];
+  }
+
+  _parseAlternation() {
+    const items = [this._parseSequence()];
+    while (this._peek() === '|') {
+      this._pos++;
+      items.push(this._parseSequence());
+    }
+    return items.length === 1 ? items[0] : {type: 'alt', items};
+  }
+
+  _parseSequence() {
+    const items = [];
+    while (this._pos < this._source.length) {
+      const c = this._peek();
+      if (c === '|' || c === ')') {
+        break;
+      }
+      items.push(this._parseQuantified());
+    }
+    if (items.length === 0) {
+      return {type: 'empty'};
+    }
+    return items.length === 1 ? items[0] : {type: 'seq', items};
+  }
+
+  _parseQuantified() {
+    const atom = this._parseAtom();
+    const quantifier = this._parseQuantifier();
+
+    if (!quantifier) {
+      return atom;
+    }
+
+    if (atom.type === 'assert') {
+      this._error('quantified assertion');
+    }
+
+    if (this._peek() === '?') {
+      this._error('lazy quantifiers are not supported');
+    }
+
+    return {type: 'repeat', node: atom, ...quantifier};
+  }
+
+  _parseQuantifier() {
+    const c = this._peek();
+
+    if (c === '*' || c === '+' || c === '?') {
+      this._pos++;
+      return {
+        min: c === '+' ? 1 : 0,
+        max: c === '?' ? 1 : Infinity,
+      };
+    }
+
+    if (c === '{') {
+      const match = /^\{(\d+)(?:(,)(\d*))?\}/.exec(
+        this._source.slice(this._pos)
+      );
+
+      // Not a quantifier, a literal `{`.
+      if (!match) {
+        return null;
+      }
+
+      this._pos += match[0].length;
+
+      const min = Number(match[1]);
+      const max = match[2] ? (match[3] ? Number(match[3]) : Infinity) : min;
+
+      if (max < min) {
+        this._error('numbers out of order in {} quantifier');
+      }
+
+      if (min > MAX_REPEAT || (max !== Infinity && max > MAX_REPEAT)) {
+        this._error(`repetition count exceeds ${MAX_REPEAT}`);
+      }
+
+      return {min, max};
+    }
+
+    return null;
+  }
+
+  _parseAtom() {
+    const c = this._peek();
+
+    switch (c) {
+      case '(':
+        return this._parseGroup();
+
+      case '[':
+        return this._parseClass();
+
+      case '.':
+        this._pos++;
+        return {type: 'set', bytes: byteSet(isDotByte)};
+
+      case '^':
+        this._pos++;
+        return {type: 'assert', kind: 'bol'};
+
+      case '$':
+        this._pos++;
+        return {type: 'assert', kind: 'eol'};
+
+      case '\\':
+        return this._parseEscape();
+
+      case '*':
+      case '+':
+      case '?':
+        this._error('nothing to repeat');
+        break;
+
+      default: {
+        const codePoint = this._source.codePointAt(this._pos);
+        this._pos += codePoint > 0xffff ? 2 : 1;
+        return this._literal(codePoint);
+      }
+    }
+  }
+
+  _parseGroup() {
+    this._pos++;
+
+    if (this._peek() === '?') {
+      if (this._peek(1) !== ':') {
+        this._error('lookaround assertions are not supported');
+      }
+      this._pos += 2;
+    }
+
+    const node = this._parseAlternation();
+
+    if (this._peek() !== ')') {
+      this._error('unterminated group');
+    }
+
+    this._pos++;
+    return node;
+  }
+
+  _parseEscape() {
+    this._pos++;
+    const c = this._peek();
+
+    if (c === undefined) {
+      this._error('\\ at end of pattern');
+    }
+
+    switch (c) {
+      case 'b':
+        this._pos++;
+        return {type: 'assert', kind: 'wordBoundary'};
+      case 'B':
+        this._pos++;
+        return {type: 'assert', kind: 'notWordBoundary'};
+    }
+
+    if (/[1-9]/.test(c)) {
+      this._error('backreferences are not supported');
+    }
+
+    const classBytes = this._parseClassEscape();
+    if (classBytes) {
+      return {type: 'set', bytes: classBytes};
+    }
+
+    return this._literal(this._parseCharEscape());
+  }
+
+  /**
+   * Parses `\d`, `\w`, `\s`, and their negations, returning a byte set.
+   */
+  _parseClassEscape() {
+    const c = this._peek();
+    const predicates = {
+      d: isDigit,
+      w: isWordByte,
+      s: isSpaceByte,
+    };
+    const predicate = predicates[c.toLowerCase()];
+
+    if (!predicate) {
+      return null;
+    }
+
+    this._pos++;
+
+    return c === c.toLowerCase()
+      ? byteSet(predicate)
+      : byteSet(b => !predicate(b));
+  }
+
+  /**
+   * Parses a character escape, returning the code point.
+   */
+  _parseCharEscape() {
+    const c = this._peek();
+    this._pos++;
+
+    switch (c) {
+      case 'n':
+        return 0x0a;
+      case 'r':
+        return 0x0d;
+      case 't':
+        return 0x09;
+      case 'f':
+        return 0x0c;
+      case 'v':
+        return 0x0b;
+      case '0':
+        return 0;
+      case 'c': {
+        const letter = this._peek();
+        if (!letter || !/[a-zA-Z]/.test(letter)) {
+          this._error('invalid control escape');
+        }
+        this._pos++;
+        return letter.charCodeAt(0) % 32;
+      }
+      case 'x':
+        return this._parseHex(2);
+      case 'u':
+        return this._parseHex(4);
+      case 'p':
+      case 'P':
+        this._error('unicode property escapes are not supported');
+    }
+
+    // Identity escape: \. \+ \/, etc.
+    return c.codePointAt(0);
+  }
+
+  _parseHex(length) {
+    const digits = this._source.substr(this._pos, length);
+    if (!new RegExp(`^[0-9a-fA-F]{${length}}$`).test(digits)) {
+      this._error('invalid hex escape');
+    }
+    this._pos += length;
+    return parseInt(digits, 16);
+  }
+
+  /**
+   * Parses a character class: [a-z_], [^"], etc.
+   */
+  _parseClass() {
+    this._pos++;
+
+    let negated = false;
+    if (this._peek() === '^') {
+      negated = true;
+      this._pos++;
+    }
+
+    const bytes = byteSet();
+
+    while (this._peek() !== ']') {
+      if (this._pos >= this._source.length) {
+        this._error('unterminated character class');
+      }
+
+      const from = this._parseClassAtom();
+
+      // Range: a-z
+      if (
+        this._peek() === '-' &&
+        this._peek(1) !== ']' &&
+        this._peek(1) !== undefined &&
+        typeof from === 'number'
+      ) {
+        this._pos++;
+        const to = this._parseClassAtom();
+
+        if (typeof to !== 'number') {
+          this._error('invalid character class range');
+        }
+
+        if (to < from) {
+          this._error('range out of order in character class');
+        }
+
+        if (to > 0xff) {
+          this._error('non-ASCII ranges are not supported');
+        }
+
+        for (let b = from; b <= to; b++) {
+          this._addClassByte(bytes, b);
+        }
+        continue;
+      }
+
+      if (typeof from === 'number') {
+        if (from > 0x7f) {
+          this._error('non-ASCII characters in classes are not supported');
+        }
+        this._addClassByte(bytes, from);
+      } else {
+        from.forEach((included, b) => {
+          if (included) {
+            bytes[b] = true;
+          }
+        });
+      }
+    }
+
+    this._pos++;
+
+    return {
+      type: 'set',
+      bytes: negated ? bytes.map(included => !included) : bytes,
+    };
+  }
+
+  /**
+   * Returns either a code point, or a byte set for class escapes.
+   */
+  _parseClassAtom() {
+    if (this._peek() !== '\\') {
+      const codePoint = this._source.codePointAt(this._pos);
+      this._pos += codePoint > 0xffff ? 2 : 1;
+      return codePoint;
+    }
+
+    this._pos++;
+
+    const c = this._peek();
+
+    if (c === undefined) {
+      this._error('\\ at end of pattern');
+    }
+
+    // Backspace in classes.
+    if (c === 'b') {
+      this._pos++;
+      return 0x08;
+    }
+
+    return this._parseClassEscape() || this._parseCharEscape();
+  }
+
+  _addClassByte(bytes, b) {
+    bytes[b] = true;
+    if (this._caseInsensitive) {
+      if (isUpper(b)) {
+        bytes[b + 32] = true;
+      } else if (isLower(b)) {
+        bytes[b - 32] = true;
+      }
+    }
+  }
+
+  /**
+   * A literal character, possibly a multi-byte UTF-8 sequence.
+   */
+  _literal(codePoint) {
+    const items = toUTF8(codePoint).map(b => {
+      const bytes = byteSet();
+      this._addClassByte(bytes, b);
+      return {type: 'set', bytes};
+    });
+    return items.length === 1 ? items[0] : {type: 'seq', items};
+  }
+}
+
+/**
+ * Bytes which can start a match of the node, and whether it matches
+ * the empty string (in which case a match can start with any byte).
+ */
+function firstBytes(node) {
+  switch (node.type) {
+    case 'empty':
+    case 'assert':
+      return {bytes: byteSet(), nullable: true};
+
+    case 'set':
+      return {bytes: node.bytes.slice(), nullable: false};
+
+    case 'seq': {
+      const bytes = byteSet();
+      for (const item of node.items) {
+        const first = firstBytes(item);
+        first.bytes.forEach((included, b) => {
+          if (included) {
+            bytes[b] = true;
+          }
+        });
+        if (!first.nullable) {
+          return {bytes, nullable: false};
+        }
+      }
+      return {bytes, nullable: true};
+    }
+
+    case 'alt': {
+      const bytes = byteSet();
+      let nullable = false;
+      for (const item of node.items) {
+        const first = firstBytes(item);
+        first.bytes.forEach((included, b) => {
+          if (included) {
+            bytes[b] = true;
+          }
+        });
+        nullable = nullable || first.nullable;
+      }
+      return {bytes, nullable};
+    }
+
+    case 'repeat': {
+      const first = firstBytes(node.node);
+      return {bytes: first.bytes, nullable: first.nullable || node.min === 0};
+    }
+
+    default:
+      throw new Error(`Unknown regexp node type: ${node.type}`);
+  }
+}
+
+/**
+ * Byte of a set which matches exactly one byte, or -1.
+ */
+function singleByte(node) {
+  if (node.type !== 'set') {
+    return -1;
+  }
+  const included = [];
+  node.bytes.forEach((isIncluded, b) => isIncluded && included.push(b));
+  return included.length === 1 ? included[0] : -1;
+}
+
+/**
+ * Shape of a regexp which can be matched without a regexp engine:
+ *
+ *   {kind: 'literal', bytes: [...]}   -- a fixed sequence of bytes
+ *   {kind: 'set', first}              -- a byte of the `first` set
+ *   {kind: 'run', first, rest}        -- a byte of the `first` set, and the
+ *                                        longest run of the `rest` set bytes,
+ *                                        e.g. `\s+`, `\d+`, `[a-z_]\w*`
+ *   {kind: 'keyword', bytes: [...]}   -- a whole word, `\bwhile\b`: the
+ *                                        longest run of the word bytes is
+ *                                        exactly the `bytes`
+ *
+ * Returns null for other regexps. The leading `^` is ignored, and so is
+ * the leading `\b` of a word: tokens start at a boundary.
+ */
+function shape(node) {
+  let items = node.type === 'seq' ? node.items : [node];
+
+  // The leading `^` anchor of the lex rules.
+  if (items[0].type === 'assert' && items[0].kind === 'bol') {
+    items = items.slice(1);
+    if (items.length === 0) {
+      return null;
+    }
+    node = items.length === 1 ? items[0] : {type: 'seq', items};
+  }
+
+  const bytes = items.map(singleByte);
+  if (bytes.every(b => b >= 0)) {
+    return {kind: 'literal', bytes};
+  }
+
+  const isWordBoundary = item =>
+    item.type === 'assert' && item.kind === 'wordBoundary';
+
+  if (items.length > 1 && isWordBoundary(items[items.length - 1])) {
+    const word = items.slice(isWordBoundary(items[0]) ? 1 : 0, -1);
+    const wordBytes = word.map(singleByte);
+    if (word.length > 0 && wordBytes.every(b => b >= 0 && isWordByte(b))) {
+      return {kind: 'keyword', bytes: wordBytes};
+    }
+  }
+
+  const isStar = item =>
+    item.type === 'repeat' &&
+    item.node.type === 'set' &&
+    item.min === 0 &&
+    item.max === Infinity;
+
+  if (
+    node.type === 'repeat' &&
+    node.node.type === 'set' &&
+    node.min === 1 &&
+    node.max === Infinity
+  ) {
+    return {kind: 'run', first: node.node.bytes, rest: node.node.bytes};
+  }
+
+  if (node.type === 'set') {
+    return {kind: 'set', first: node.bytes};
+  }
+
+  if (items.length === 2 && items[0].type === 'set' && isStar(items[1])) {
+    return {kind: 'run', first: items[0].bytes, rest: items[1].node.bytes};
+  }
+
+  return null;
+}
+
+/**
+ * Byte set as the list of `[from, to]` ranges.
+ */
+function byteRanges(bytes) {
+  const ranges = [];
+  for (let b = 0; b < 256; b++) {
+    if (!bytes[b]) {
+      continue;
+    }
+    const last = ranges[ranges.length - 1];
+    if (last && last[1] === b - 1) {
+      last[1] = b;
+    } else {
+      ranges.push([b, b]);
+    }
+  }
+  return ranges;
+}
+
+export default {
+  /**
+   * Parses a regexp source into the AST.
+   *
+   * Options:
+   *
+   *   - caseInsensitive: boolean
+   */
+  parse(source, options) {
+    return new RegExpParser(source, options).parse();
+  },
+
+  firstBytes,
+
+  shape,
+
+  byteRanges,
+
+  isWordByte,
+};
@@ -3,6 +3,9 @@
  * Copyright (c) 2015-present Dmitry Soshnikov <dmitry.soshnikov@gmail.com>
  */
 
+import LexDFA from '../../dfa/lex-dfa';
+import RegExpParser from '../../dfa/regexp-parser';
+
 import fs from 'fs';
 import colors from 'colors';
 
@@ -14,11 +17,135 @@ const CPP_TOKENIZER_TEMPLATE = fs.readFileSync(
   'utf-8'
 );
 
+/**
+ * C++ direct-coded LR driver template (`--driver coded`).
+ */
+const CPP_LR_CODED_TEMPLATE = fs.readFileSync(
+  `${__dirname}/templates/lr-coded.template.h`,
+  'utf-8'
+);
+
+/**
+ * Default depth the parsing stacks are reserved for.
+ */
+const DEFAULT_STACK_RESERVE = 64;
+
+/**
+ * FNV-1a prime, and the initial seed, of the keywords perfect hash.
+ */
+const KEYWORD_HASH_PRIME = 16777619;
+const KEYWORD_HASH_SEED = 2166136261;
+
+/**
+ * Seeds tried for a keywords hash table size, before doubling it.
+ */
+const KEYWORD_HASH_TRIES = 1000;
+
+/**
+ * Token of the error productions, yacc-style: `stmt : error ';'`.
+ */
+const ERROR_TOKEN = 'error';
+
 /**
  * The trait is used by parser generators (LL/LR) for C++.
  */
 const CppParserGeneratorTrait = {
 
+  /**
+   * Generator options, which select the parts of the templates
+   * to compile, e.g. the lexer backend.
+   */
+  generateOptions() {
+    const defines = {
+      SYNTAX_LEXER_DFA: this._usesDFALexer() ? 1 : 0,
+      SYNTAX_PARSER_RECOVERY: this._usesErrorRecovery() ? 1 : 0,
+      SYNTAX_PARSER_CODED: this._usesCodedDriver() ? 1 : 0,
+    };
+
+    // Defaults, which can be overridden when compiling.
+    const defaults = {
+      SYNTAX_PARSER_ARENA: this._usesArena() ? 1 : 0,
+      SYNTAX_PARSER_STACK_RESERVE: DEFAULT_STACK_RESERVE,
+      SYNTAX_PARSER_THREADS: 1,
+      SYNTAX_PARSER_REPARSE: 1,
+      SYNTAX_PARSER_STATS: 0,
+      SYNTAX_PARSER_COMPACT: 1,
+      SYNTAX_LEXER_SIMD: 1,
+    };
+
+    // The LL parsers have none of the LR parser features.
+    if (this._grammar.getMode().isLL()) {
+      delete defines.SYNTAX_PARSER_RECOVERY;
+      ['SYNTAX_PARSER_ARENA', 'SYNTAX_PARSER_THREADS',
+       'SYNTAX_PARSER_REPARSE', 'SYNTAX_PARSER_COMPACT']
+        .forEach(name => delete defaults[name]);
+    }
+
+    this.writeData(
+      'GENERATOR_OPTIONS',
+      Object.keys(defines)
+        .map(name => `#define ${name} ${defines[name]}`)
+        .concat(Object.keys(defaults).map(name =>
+          `#ifndef ${name}\n#define ${name} ${defaults[name]}\n#endif`
+        ))
+        .join('\n'),
+    );
+  },
+
+  /**
+   * Whether the grammar has the productions with the `error` token, which
+   * enables the yacc-style error recovery.
+   */
+  _usesErrorRecovery() {
+    return this._tokens.hasOwnProperty(ERROR_TOKEN);
+  },
+
+  /**
+   * Whether the grammar uses the parser arena (`parser.arena()`) in
+   * the semantic actions, or in the module include.
+   */
+  _usesArena() {
+    const usesArena = code => /\barena\(\)/.test(code || '');
+
+    return usesArena(this._grammar.getModuleInclude()) ||
+      this._grammar.getProductions().some(production =>
+        usesArena(production.getRawSemanticAction())
+      );
+  },
+
+  /**
+   * Whether the lexer is compiled into a DFA (`--lexer dfa`), instead
+   * of matching `std::regex` rules one by one.
+   */
+  _usesDFALexer() {
+    const lexer = this.getOptions().lexer || 'regex';
+
+    if (lexer !== 'regex' && lexer !== 'dfa') {
+      throw new Error(
+        `C++ plugin: unknown lexer "${lexer}", expected "regex" or "dfa".`
+      );
+    }
+
+    return lexer === 'dfa';
+  },
+
+  /**
+   * Whether the LR automaton is compiled into code (`--driver coded`),
+   * instead of interpreting the parsing table; for the LL parsers, a
+   * recursive descent.
+   */
+  _usesCodedDriver() {
+    const driver = this.getOptions().driver || 'table';
+
+    if (driver !== 'table' && driver !== 'coded') {
+      throw new Error(
+        `C++ plugin: unknown driver "${driver}", expected "table" or "coded".`
+      );
+    }
+
+    return driver === 'coded';
+  },
+
   /**
    * Generates parser class name.
    */
@@ -31,63 +158,246 @@ const CppParserGeneratorTrait = {
 
     // Alias:
     this.writeData('PARSER_CLASS_NAME', className);
+
+    // Constructor:
+    this.writeData('PARSER_CLASS_NAME', className);
   },
 
   /**
-   * Generates parsing table in C++ map format.
+   * Generates parsing table as a dense array of entries.
    */
   generateParseTable() {
-    this.writeData(
-      'TABLE',
-      this._buildTable(this.generateParseTableData()),
-    );
+    const table = this.generateParseTableData();
+
+    this.writeData('TABLE', this._buildTable(table));
+    this._generateCodedDriver(table);
+  },
+
+  /**
+   * Generates the direct-coded driver (`--driver coded`): the actions of
+   * each state as a `switch` on the lookahead token, the reductions as a
+   * `switch` on the production, and the gotos as a `switch` on the state.
+   *
+   * Example:
+   *
+   *   case 3:
+   *     switch (token.type) {
+   *       case TokenType::NUMBER: SHIFT_TO(5);
+   *       case TokenType::TOKEN_TYPE_7:
+   *       case TokenType::__EOF: REDUCE_BY(2);
+   *       default: goto error;
+   *     }
+   */
+  _generateCodedDriver(table) {
+    if (!this._usesCodedDriver()) {
+      this.writeData('CODED_DRIVER', '');
+      return;
+    }
+
+    this.writeData('CODED_DRIVER', `\n${CPP_LR_CODED_TEMPLATE}`);
+
+    const tokenTypes = {};
+    Object.keys(this._tokens).forEach(token => {
+      tokenTypes[this._tokens[token]] = this._cppTokenType(token);
+    });
+
+    // Gotos of each non-terminal: state -> next state.
+    const gotos = {};
+
+    const actions = Object.keys(table).map(state => {
+      const row = table[state];
+      const cases = [];
+      const reductions = {};
+
+      Object.keys(row).forEach(key => {
+        const entry = String(row[key]);
+
+        if (!tokenTypes.hasOwnProperty(key)) {
+          (gotos[key] = gotos[key] || []).push([state, entry]);
+          return;
+        }
+
+        const label = `case TokenType::${tokenTypes[key]}:`;
+
+        if (entry[0] === 's') {
+          cases.push(`${label} SHIFT_TO(${entry.slice(1)});`);
+        } else if (entry[0] === 'r') {
+          // The tokens reducing by the same production share the case.
+          const production = entry.slice(1);
+          if (!reductions.hasOwnProperty(production)) {
+            reductions[production] = [];
+            cases.push(reductions[production]);
+          }
+          reductions[production].push(label);
+        } else if (entry === 'acc') {
+          cases.push(`${label} goto accept;`);
+        }
+      });
+
+      Object.keys(reductions).forEach(production => {
+        const labels = reductions[production];
+        labels[labels.length - 1] += ` REDUCE_BY(${production});`;
+      });
+
+      const lines = [].concat(...cases).concat('default: goto error;');
+
+      return `// ${state}\n    case ${state}:\n` +
+        '      switch (token.type) {\n' +
+        `        ${lines.join('\n        ')}\n` +
+        '      }';
+    });
+
+    this.writeData('CODED_ACTIONS', actions.join('\n    '));
+
+    const reductions = this._grammar.getProductions()
+      .filter(production => !production.isAugmented())
+      .map(production => {
+        const number = production.getNumber();
+        const rhsLength = production.isEpsilon()
+          ? 0
+          : production.getRHS().length;
+        const symbol = this.getEncodedNonTerminal(
+          production.getLHS().getSymbol()
+        );
+
+        const lines = new Array(rhsLength).fill('statesStack.pop_back();');
+        if (this._productionActions[number]) {
+          lines.push(this._productionActions[number]);
+        }
+        lines.push(
+          `statesStack.push_back(goto_(${symbol}, statesStack.back()));`
+        );
+        lines.push('break;');
+
+        return `case ${number}:
+      ${lines.join('\n      ')}`;
+      });
+
+    this.writeData('CODED_REDUCTIONS', reductions.join('\n    '));
+
+    // The most common next state of a non-terminal is the default.
+    const codedGotos = Object.keys(gotos).map(symbol => {
+      const counts = {};
+      gotos[symbol].forEach(([, next]) =>
+        counts[next] = (counts[next] || 0) + 1
+      );
+      const defaultState = Object.keys(counts)
+        .reduce((a, b) => counts[b] > counts[a] ? b : a);
+
+      const cases = gotos[symbol]
+        .filter(([, next]) => next !== defaultState)
+        .map(([state, next]) => `case ${state}: return ${next};`)
+        .concat(`default: return ${defaultState};`);
+
+      return `case ${symbol}:\n      switch (state) {\n` +
+        `        ${cases.join('\n        ')}\n      }`;
+    });
+
+    this.writeData('CODED_GOTOS', codedGotos.join('\n    '));
   },
 
   /**
    * Converts JS object into C++ array.
    *
-   * In C++ we represent a table as an std::array, where index is a state number,
-   * and a value is a struct of LR entries (shift/reduce/etc).
+   * In C++ we represent a table as a flat constexpr array of LR entries
+   * (shift/reduce/etc), indexed by `state * SYMBOLS_COUNT + symbol`, where
+   * symbol is an encoded terminal or non-terminal. Missing entries are
+   * errors, `{}`.
    *
    * Example:
    *
-   *   std::vector<Row> table {
-   *     Row {
-   *       {0, {TE::Shift, 4}},
-   *       {5, {TE::Reduce, 2}},
-   *       {3, {TE::Accept, 0}},
-   *     }
-   *    };
+   *   static constexpr TableEntry table_[ROWS_COUNT * SYMBOLS_COUNT] = {
+   *     // 0
+   *     {TE::Transit, 1}, {}, {TE::Shift, 4}, {}, {TE::Accept, 0},
+   *     ...
+   *   };
    */
   _buildTable(table) {
-    const entries = Object.keys(table).map(state => {
+    const symbolsCount =
+      Object.keys(this._nonTerminals).length +
+      Object.keys(this._tokens).length;
+
+    // Whether the symbol of a state is on the tokens stack: the states
+    // shifting a token, or a non-terminal propagating a token.
+    const nonTerminals = {};
+    Object.keys(this._nonTerminals).forEach(symbol => {
+      nonTerminals[this._nonTerminals[symbol]] = symbol;
+    });
+    const stateTokens = new Array(Object.keys(table).length).fill(0);
+    const stateTerminals = new Array(Object.keys(table).length).fill(0);
+
+    const rows = Object.keys(table).map(state => {
       const row = table[state];
+      const entries = new Array(symbolsCount).fill('{}');
 
-      // Transform to C++ enum format: "s3" => {A::Shift, 3}, etc
+      // Transform to C++ enum format: "s3" => {TE::Shift, 3}, etc
       Object.keys(row).forEach(key => {
-        const entry = row[key];
+        const entry = String(row[key]);
+        let cppEntry;
         if (entry[0] === 's') {
-          row[key] = `{TE::Shift, ${entry.slice(1)}}`;
+          cppEntry = `{TE::Shift, ${entry.slice(1)}}`;
+          stateTokens[Number(entry.slice(1))] = 1;
+          stateTerminals[Number(entry.slice(1))] = 1;
         } else if (entry[0] === 'r') {
-          row[key] = `{TE::Reduce, ${entry.slice(1)}}`;
+          cppEntry = `{TE::Reduce, ${entry.slice(1)}}`;
         } else if (entry === 'acc') {
-          row[key] = `{TE::Accept, 0}`;
+          cppEntry = `{TE::Accept, 0}`;
         } else {
-          row[key] = `{TE::Transit, ${entry}}`;
+          cppEntry = `{TE::Transit, ${entry}}`;
+          if (this._derivesPropagatingToken(nonTerminals[key])) {
+            stateTokens[Number(entry)] = 1;
+          }
         }
+        entries[Number(key)] = cppEntry;
       });
 
-      return this._toCppMap(
-        table[state],
-        'Row',
-        'number',
-        'raw',
-      );
+      return `// ${state}\n    ${entries.join(', ')}`;
     });
 
-    this.writeData('ROWS_COUNT', entries.length);
+    this.writeData('ROWS_COUNT', rows.length);
+    this.writeData('SYMBOLS_COUNT', symbolsCount);
+    this.writeData('STATE_TOKENS', `{${stateTokens.join(', ')}}`);
+    this.writeData('STATE_TERMINALS', `{${stateTerminals.join(', ')}}`);
+
+    this._generateCompactTypes(rows.length, symbolsCount);
+
+    return `{\n    ${rows.join(',\n    ')}\n  }`;
+  },
+
+  /**
+   * Narrowest integer types of the states, the table entries (packing the
+   * entry type in 3 bits, and a state or a production number), and the
+   * productions (`SYNTAX_PARSER_COMPACT`).
+   */
+  _generateCompactTypes(statesCount, symbolsCount) {
+    const productions = this._grammar.getProductions();
+    const maxValue = Math.max(statesCount, productions.length) - 1;
+    const maxRHSLength = Math.max(...productions.map(production =>
+      production.isEpsilon() ? 0 : production.getRHS().length
+    ));
+
+    // The states are at least 16-bit: a stack of `uint8_t`, which is an
+    // `unsigned char`, may alias any memory, and pessimizes the parsing loop.
+    this.writeData(
+      'STATE_TYPE',
+      this._cppIntType(Math.max(statesCount - 1, 0xff + 1)),
+    );
+    this.writeData('TABLE_WORD_TYPE', this._cppIntType(maxValue * 8 + 7));
+    this.writeData(
+      'SYMBOL_TYPE',
+      this._cppIntType(symbolsCount, /* signed */ true),
+    );
+    this.writeData('RHS_LENGTH_TYPE', this._cppIntType(maxRHSLength));
+  },
 
-    return `{\n    ${entries.join(',\n    ')}\n}`;
+  /**
+   * Whether the value of a non-terminal is a propagated token, kept on the
+   * tokens stack.
+   */
+  _derivesPropagatingToken(nonTerminal) {
+    return this._grammar
+      .getProductionsForSymbol(nonTerminal)
+      .some(production => production.derivesPropagatingToken());
   },
 
   /**
@@ -104,37 +414,121 @@ const CppParserGeneratorTrait = {
    * Generates final parsed result.
    */
   generateParsedResult() {
-    const stack =
+    // A propagated token is a view, which is converted to the `Value`.
+    const result =
       this._grammar.getAugmentedProduction().derivesPropagatingToken()
-        ? 'tokensStack'
-        : 'valuesStack';
+        ? 'auto result = Value(tokensStack.back()); tokensStack.pop_back();'
+        : 'auto result = std::move(valuesStack.back()); valuesStack.pop_back();';
 
-    this.writeData(
-      'PARSED_RESULT',
-      `auto result = ${stack}.back(); ${stack}.pop_back();`
-    );
+    this.writeData('PARSED_RESULT', result);
   },
 
   /**
-   * Production handlers are implemented as methods on the `yyparse` class.
+   * Production handlers are implemented as functions taking the `yyparse`
+   * parser, named by the production number, and dispatched by it in
+   * `yyparse::handle_`. The productions passing a value through, and those
+   * without a semantic action, are only the stack operations.
    */
   buildSemanticAction(production) {
-    let action = this.getSemanticActionCode(production);
+    const number = production.getNumber();
+    const stackAction = this._buildStackAction(production);
 
-    if (!action) {
+    if (stackAction !== null) {
+      this._productionActions[number] = stackAction;
       return null;
     }
 
+    let action = this.getSemanticActionCode(production);
+
     action = this._actionFromHandler(action);
 
+    // The handlers get the parser, the `yytext` is of its tokenizer.
+    action = action.replace(/\btokenizer\.yytext\b/g, 'parser.tokenizer.yytext');
+
+    // The argument assigned to `$$` by the last statement is not used
+    // after it, so is moved to the result.
+    action = action.replace(
+      /\bauto __ = (_\d+);$/,
+      'auto __ = std::move($1);'
+    );
+
     const argsInfo = this._getParamsInfo(production, action);
 
     action = this._generateHandlerPrologue(production, action, argsInfo);
-    action = this._generateHandlerEpilogue(production, action);
+    action = this._generateHandlerEpilogue(production, action, argsInfo);
 
     // Save the action, they are injected later.
-    this._productionHandlers.push({args: ['yyparse& parser'], action});
-    return `"_handler${this._productionHandlers.length}"`;
+    this._productionHandlers[number] = {args: ['yyparse& parser'], action};
+    this._productionActions[number] = `_handler${number + 1}(parser);`;
+    return `"_handler${number + 1}"`;
+  },
+
+  /**
+   * Stack operations of a production which needs no handler, or null:
+   *
+   *   - passing through the first argument on the stack of its result,
+   *     `$$ = $1` in `E : T`, or `$$ = $2` in `E : '(' E ')'`, leaves it
+   *     on the stack, and drops the other arguments;
+   *
+   *   - without a semantic action (an epsilon production, or one with
+   *     several symbols), drops the arguments, and pushes the default
+   *     `Value` (which requires a default-constructible one).
+   */
+  _buildStackAction(production) {
+    if (this._grammar.shouldCaptureLocations()) {
+      return null;
+    }
+
+    const rawAction = production.getRawSemanticAction();
+    const argsInfo = this._getParamsInfo(production, '');
+    const counts = this._countStackArgs(production, argsInfo);
+    const stackOf = name =>
+      this._isTokenArg(production, argsInfo[name]) ? 'T' : 'V';
+
+    const drops = () => ['T', 'V']
+      .filter(stack => counts[stack] > 0)
+      .map(stack => `DROP_${stack}(${counts[stack]});`);
+
+    if (!rawAction) {
+      return drops().concat('PUSH_DEFAULT_V();').join(' ');
+    }
+
+    const match = /^\s*\$\$\s*=\s*\$(\d+)\s*;?\s*$/.exec(rawAction);
+
+    if (!match || !argsInfo.hasOwnProperty(`_${match[1]}`)) {
+      return null;
+    }
+
+    const name = `_${match[1]}`;
+    const stack = stackOf(name);
+    const resultStack = production.derivesPropagatingToken() ? 'T' : 'V';
+
+    // A token converted to the `Value`, or a value under another one on
+    // its stack, is moved by the handler.
+    if (stack !== resultStack ||
+        Object.keys(argsInfo).find(arg => stackOf(arg) === stack) !== name) {
+      return null;
+    }
+
+    counts[stack]--;
+    return drops().join(' ');
+  },
+
+  /**
+   * Whether handlers refer to the arguments in place on the stack
+   * (`--handler-args inplace`), instead of moving them off the stack.
+   */
+  _usesInPlaceArgs() {
+    const handlerArgs = this.getOptions().handlerArgs || 'pop';
+
+    if (handlerArgs !== 'pop' && handlerArgs !== 'inplace') {
+      throw new Error(
+        `C++ plugin: unknown handler args mode "${handlerArgs}", ` +
+        `expected "pop" or "inplace".`
+      );
+    }
+
+    return handlerArgs === 'inplace';
   },
 
   /**
@@ -148,35 +542,58 @@ const CppParserGeneratorTrait = {
     production.getRHS().forEach((symbol, index) => {
       const name = `_${index + 1}`;
       info[name] = {
-        isUsed: action.includes(name),
+        isUsed: new RegExp(`\\b${name}\\b`).test(action),
         isToken: this._grammar.isTokenSymbol(symbol),
       };
     });
     return info;
   },
 
+  /**
+   * Whether the argument is on the tokens stack.
+   */
+  _isTokenArg(production, info) {
+    return info.isToken || production.derivesPropagatingToken();
+  },
+
   /**
    * Generates prologue for fetching arguments from the parsing stack.
    */
   _generateHandlerPrologue(production, action, argsInfo) {
     const argsPrologue = [];
 
-    Object.keys(argsInfo).reverse().forEach(name => {
-      const info = argsInfo[name];
-      if (info.isToken || production.derivesPropagatingToken()) {
-        argsPrologue.push(
-          info.isUsed
-           ? `auto ${name} = POP_T();`
-           : `parser.tokensStack.pop_back();`
-        );
-      } else {
-        argsPrologue.push(
-          info.isUsed
-           ? `auto ${name} = POP_V();`
-           : `parser.valuesStack.pop_back();`
-        );
-      }
-    });
+    if (this._usesInPlaceArgs()) {
+      // Arguments are references to the stack entries: counting
+      // from the top of each stack.
+      const counts = this._countStackArgs(production, argsInfo);
+      const positions = {T: counts.T, V: counts.V};
+
+      Object.keys(argsInfo).forEach(name => {
+        const info = argsInfo[name];
+        const stack = this._isTokenArg(production, info) ? 'T' : 'V';
+        if (info.isUsed) {
+          argsPrologue.push(`auto& ${name} = STACK_${stack}(${positions[stack]});`);
+        }
+        positions[stack]--;
+      });
+    } else {
+      Object.keys(argsInfo).reverse().forEach(name => {
+        const info = argsInfo[name];
+        if (this._isTokenArg(production, info)) {
+          argsPrologue.push(
+            info.isUsed
+             ? `auto ${name} = POP_T();`
+             : `parser.tokensStack.pop_back();`
+          );
+        } else {
+          argsPrologue.push(
+            info.isUsed
+             ? `auto ${name} = POP_V();`
+             : `parser.valuesStack.pop_back();`
+          );
+        }
+      });
+    }
 
     return (
       '// Semantic action prologue.\n' +
@@ -185,16 +602,40 @@ const CppParserGeneratorTrait = {
     );
   },
 
+  /**
+   * Number of arguments on the tokens (T) and values (V) stacks.
+   */
+  _countStackArgs(production, argsInfo) {
+    const counts = {T: 0, V: 0};
+    Object.keys(argsInfo).forEach(name => {
+      counts[this._isTokenArg(production, argsInfo[name]) ? 'T' : 'V']++;
+    });
+    return counts;
+  },
+
   /**
    * Generates handler epilogue.
    */
-  _generateHandlerEpilogue(production, action) {
-    const pushResult = production.derivesPropagatingToken()
-      ? 'PUSH_TR'
-      : 'PUSH_VR';
+  _generateHandlerEpilogue(production, action, argsInfo) {
+    const epilogue = [];
+
+    // In-place arguments are dropped from the stacks after the action.
+    if (this._usesInPlaceArgs()) {
+      const counts = this._countStackArgs(production, argsInfo);
+      ['T', 'V'].forEach(stack => {
+        if (counts[stack] > 0) {
+          epilogue.push(`DROP_${stack}(${counts[stack]});`);
+        }
+      });
+    }
+
+    epilogue.push(
+      production.derivesPropagatingToken() ? 'PUSH_TR();' : 'PUSH_VR();'
+    );
+
     return (
       `${action}\n\n // Semantic action epilogue.\n` +
-      `${pushResult}();\n`
+      `${epilogue.join('\n')}\n`
     );
   },
 
@@ -204,8 +645,14 @@ const CppParserGeneratorTrait = {
   generateProductions() {
     this.writeData(
       'PRODUCTIONS',
-      `{{${this.generateProductionsData().join(',\n')}}}`
+      `{\n    ${this.generateProductionsData().join(',\n    ')}\n  }`
     );
+
+    // Names for the statistics (`SYNTAX_PARSER_STATS`).
+    const names = this._grammar.getProductions()
+      .map(production => this._toCppString(production.toFullString()));
+
+    this.writeData('PRODUCTION_NAMES', `{\n    ${names.join(',\n    ')}\n  }`);
   },
 
   /**
@@ -225,9 +672,12 @@ const CppParserGeneratorTrait = {
       );
     }
 
-    // Parser hooks.
+    // Parser hooks. The parsing string is passed as `std::string_view`,
+    // older hooks accepting `const std::string&` get a copy.
     const onParseBegin = moduleInclude.includes('void onParseBegin')
-      ? 'onParseBegin(str);'
+      ? (/void\s+onParseBegin\s*\(\s*(?:const\s+)?std::string\s*&/.test(moduleInclude)
+        ? 'onParseBegin(std::string{str});'
+        : 'onParseBegin(str);')
       : '';
 
     const onParseEnd = moduleInclude.includes('void onParseEnd')
@@ -249,10 +699,7 @@ const CppParserGeneratorTrait = {
       this._grammar.getProductions().length,
     );
     return this.generateRawProductionsData()
-      .map((data, index) => {
-        data[2] = `&_handler${index + 1}`;
-        return `{${data.join(', ')}}`;
-      });
+      .map(data => `{${data.slice(0, 2).join(', ')}}`);
   },
 
   /**
@@ -293,40 +740,509 @@ const CppParserGeneratorTrait = {
       let action = this._actionFromHandler(handler);
 
       this._lexHandlers.push({
-        args: 'const Tokenizer& tokenizer, const std::string& yytext',
+        args: '[[maybe_unused]] const Tokenizer& tokenizer, ' +
+          '[[maybe_unused]] std::string_view yytext',
         action,
       });
 
-      return `{std::regex(R"(${lexRule.getRawMatcher()})"), ` +
+      if (this._usesDFALexer()) {
+        return `{&_lexRule${this._lexHandlers.length}}`;
+      }
+
+      return `{R"(${lexRule.getRawMatcher()})", ` +
         `&_lexRule${this._lexHandlers.length}}`;
     });
 
     this.writeData('LEX_RULES_COUNT', lexRules.length);
 
     this.writeData('LEX_RULES', `{{\n  ${lexRules.join(',\n  ')}\n}}`);
+
+    // Names for the statistics (`SYNTAX_PARSER_STATS`).
+    const names = this._grammar.getLexGrammar().getRules()
+      .map(lexRule => this._toCppString(lexRule.getOriginalMatcher()));
+
+    this.writeData('LEX_RULE_NAMES', `{\n    ${names.join(',\n    ')}\n  }`);
+  },
+
+  /**
+   * Generates the lexer DFA tables (`--lexer dfa`): all rules of each
+   * start condition are compiled into one minimized automaton.
+   */
+  generateLexDFA() {
+    if (!this._usesDFALexer()) {
+      this.writeData('LEX_DFA', '');
+      return;
+    }
+
+    const dfa = LexDFA.fromLexGrammar(this._grammar.getLexGrammar());
+
+    const statesCount = dfa.getStatesCount();
+    const classesCount = dfa.getClassesCount();
+    const stateType = this._cppIntType(statesCount - 1);
+    const ruleType = this._cppIntType(
+      this._grammar.getLexGrammar().getRules().length,
+      /* signed */ true,
+    );
+
+    const array = (type, name, data) =>
+      `static constexpr ${type} ${name}[${data.length}] = ` +
+      `${this._toCppArray(data)};`;
+
+    const runs = this._dfaRuns(dfa);
+
+    this.writeData('LEX_DFA', [
+      `// ${statesCount} states, ${classesCount} byte classes.`,
+      `static constexpr size_t DFA_CLASSES_COUNT = ${classesCount};`,
+      array('uint8_t', 'dfaClasses_', dfa.getClasses()),
+      array('uint8_t', 'dfaClassKinds_', dfa.getClassKinds()),
+      array(stateType, 'dfaTransitions_', dfa.getTransitions()),
+      array(ruleType, 'dfaAccepts_', dfa.getAccepts()),
+      array(stateType, 'dfaStartStates_', dfa.getStartStates()),
+      '',
+      '// Runs of the self-loops: state -> index in dfaRunRanges_, or -1.',
+      `static constexpr size_t DFA_RUNS_COUNT = ${runs.ranges.length};`,
+      array(
+        this._cppIntType(runs.ranges.length, /* signed */ true),
+        'dfaRuns_',
+        runs.indices,
+      ),
+      `static constexpr ByteRanges dfaRunRanges_[${
+        Math.max(runs.ranges.length, 1)
+      }] = {\n    ${
+        runs.ranges.length > 0 ? runs.ranges.join(',\n    ') : '{}'
+      }\n  };`,
+    ].join('\n  '));
+  },
+
+  /**
+   * DFA states which loop to themselves on a set of bytes, like in `\s+`,
+   * where the tokenizer can skip the whole run of those bytes at once.
+   * The set should be of one next position kind (all word, or all non-word
+   * bytes), so that the accepting rule is the same along the run.
+   */
+  _dfaRuns(dfa) {
+    const classesCount = dfa.getClassesCount();
+    const classes = dfa.getClasses();
+    const classKinds = dfa.getClassKinds();
+    const transitions = dfa.getTransitions();
+
+    const indices = [];
+    const ranges = [];
+
+    for (let state = 0; state < dfa.getStatesCount(); state++) {
+      const bytes = classes.map(byteClass =>
+        state !== 0 &&
+        transitions[state * classesCount + byteClass] === state
+      );
+
+      const kinds = new Set(
+        classes.filter((byteClass, b) => bytes[b])
+          .map(byteClass => classKinds[byteClass])
+      );
+
+      const cppRanges = kinds.size === 1 ? this._cppByteRanges(bytes) : null;
+
+      if (cppRanges) {
+        indices.push(ranges.length);
+        ranges.push(cppRanges);
+      } else {
+        indices.push(-1);
+      }
+    }
+
+    return {indices, ranges};
+  },
+
+  /**
+   * `ByteRanges` initializer of a byte set (up to 4 ranges, for the SIMD
+   * scanning kernels), or null.
+   */
+  _cppByteRanges(bytes) {
+    const ranges = RegExpParser.byteRanges(bytes);
+
+    if (ranges.length === 0 || ranges.length > 4) {
+      return null;
+    }
+
+    // Unused slots repeat the first range.
+    while (ranges.length < 4) {
+      ranges.push(ranges[0]);
+    }
+
+    const hex = b => `0x${('0' + b.toString(16)).slice(-2)}`;
+
+    return `{{${ranges.map(([from]) => hex(from)).join(', ')}}, ` +
+      `{${ranges.map(([from, to]) => hex(to - from)).join(', ')}}}`;
+  },
+
+  /**
+   * Generates the shapes of the lex rules for the regex lexer: literals,
+   * byte sets, and runs of byte sets (like `\s+`, `\d+`, identifiers) are
+   * matched by the scanning kernels instead of the regex engine.
+   */
+  generateLexRulesMatchers() {
+    if (this._usesDFALexer()) {
+      this.writeData('LEX_RULES_MATCHERS', '');
+      return;
+    }
+
+    const octal = b => `\\${('00' + b.toString(8)).slice(-3)}`;
+
+    const keywordGroups = this._keywordGroups();
+    const wordRanges = this._cppByteRanges(
+      new Array(256).fill(false).map((_, b) => RegExpParser.isWordByte(b))
+    );
+
+    const rows = this._grammar.getLexGrammar().getRules().map((lexRule, index) => {
+      const group = keywordGroups.byRule[index];
+
+      if (group) {
+        return `{LexRuleShape::Keyword, {}, ${wordRanges}, {}, ${group.number}}`;
+      }
+
+      let shape = null;
+
+      try {
+        shape = RegExpParser.shape(
+          RegExpParser.parse(lexRule.getRawMatcher(), {
+            caseInsensitive: lexRule.isCaseInsensitive(),
+          })
+        );
+      } catch (e) {
+        /* not supported, matched by the regex */
+      }
+
+      if (shape && shape.kind === 'literal') {
+        return `{LexRuleShape::Literal, {}, {}, ` +
+          `{"${shape.bytes.map(octal).join('')}", ${shape.bytes.length}}, 0}`;
+      }
+
+      if (shape && shape.kind === 'set') {
+        const first = this._cppByteRanges(shape.first);
+
+        if (first) {
+          return `{LexRuleShape::Byte, ${first}, {}, {}, 0}`;
+        }
+      }
+
+      if (shape && shape.kind === 'run') {
+        const first = this._cppByteRanges(shape.first);
+        const rest = this._cppByteRanges(shape.rest);
+
+        if (first && rest) {
+          return `{LexRuleShape::Run, ${first}, ${rest}, {}, 0}`;
+        }
+      }
+
+      return '{LexRuleShape::Regex, {}, {}, {}, 0}';
+    });
+
+    this.writeData(
+      'LEX_RULES_MATCHERS',
+      [
+        `static constexpr LexRuleMatcher lexRulesMatchers_[${rows.length}] = ` +
+          `{\n    ${rows.join(',\n    ')}\n  };`,
+        '',
+        this._generateKeywordTables(keywordGroups.groups),
+      ].join('\n  '),
+    );
   },
 
   /**
-   * Lex rules by start condition.
+   * Groups of the keyword lex rules (`\bwhile\b`) of the regex lexer: the
+   * runs of consecutive keyword rules with the same start conditions. A
+   * group is matched at the position of its first rule, by one lookup of
+   * the word at the cursor in the perfect hash table of the group, so the
+   * other rules of the group are not in the rule spans. Returns the
+   * `groups`, and the group of each first rule (`byRule`), with null for
+   * the other rules of the groups.
+   */
+  _keywordGroups() {
+    if (this._keywordGroupsData) {
+      return this._keywordGroupsData;
+    }
+
+    const groups = [];
+    const byRule = [];
+
+    if (!this._usesDFALexer()) {
+      let group = null;
+
+      this._grammar.getLexGrammar().getRules().forEach((lexRule, index) => {
+        const word = this._keywordOf(lexRule);
+        const conditions = JSON.stringify(lexRule.getStartConditions() || []);
+
+        if (!word) {
+          group = null;
+          return;
+        }
+
+        if (group && group.conditions === conditions) {
+          // A repeated word never matches: the first one wins.
+          if (!group.words.has(word)) {
+            group.words.set(word, index);
+          }
+          byRule[index] = null;
+          return;
+        }
+
+        group = {number: groups.length, conditions, words: new Map()};
+        group.words.set(word, index);
+        groups.push(group);
+        byRule[index] = group;
+      });
+    }
+
+    this._keywordGroupsData = {groups, byRule};
+    return this._keywordGroupsData;
+  },
+
+  /**
+   * The word of a keyword lex rule, as a binary string, or null.
+   */
+  _keywordOf(lexRule) {
+    try {
+      const shape = RegExpParser.shape(
+        RegExpParser.parse(lexRule.getRawMatcher(), {
+          caseInsensitive: lexRule.isCaseInsensitive(),
+        })
+      );
+      if (shape && shape.kind === 'keyword') {
+        return String.fromCharCode(...shape.bytes);
+      }
+    } catch (e) {
+      /* not supported, matched by the regex */
+    }
+    return null;
+  },
+
+  /**
+   * Generates the perfect hash tables of the keyword groups: a seed of the
+   * hash with no collisions between the words of a group is searched for,
+   * in a table of twice the number of words (doubled, if no seed is
+   * found), so a word is looked up with one probe.
+   */
+  _generateKeywordTables(groups) {
+    const tables = [];
+    const slots = [];
+
+    groups.forEach(group => {
+      const words = [...group.words.keys()];
+
+      let size = 2;
+      while (size < 2 * words.length) {
+        size *= 2;
+      }
+
+      for (;;) {
+        const seed = this._findKeywordSeed(words, size - 1);
+        if (seed !== null) {
+          const table = new Array(size).fill('{{}, -1}');
+          words.forEach(word => {
+            const slot = this._keywordHash(word, seed) & (size - 1);
+            const string = Buffer.from(word, 'latin1').toString('utf8');
+            table[slot] =
+              `{{${this._toCppString(string)}, ${word.length}}, ` +
+              `${group.words.get(word)}}`;
+          });
+          tables.push(`{${seed}u, ${size - 1}, ${slots.length}}`);
+          slots.push(...table);
+          break;
+        }
+        size *= 2;
+      }
+    });
+
+    if (tables.length === 0) {
+      tables.push('{}');
+      slots.push('{{}, -1}');
+    }
+
+    return [
+      `static constexpr KeywordTable keywordTables_[${tables.length}] = ` +
+        `{\n    ${tables.join(',\n    ')}\n  };`,
+      `static constexpr KeywordSlot keywordSlots_[${slots.length}] = ` +
+        `{\n    ${slots.join(',\n    ')}\n  };`,
+    ].join('\n  ');
+  },
+
+  /**
+   * Seed of the keywords hash without collisions in the table, or null.
+   */
+  _findKeywordSeed(words, mask) {
+    for (let i = 0; i < KEYWORD_HASH_TRIES; i++) {
+      const seed = (KEYWORD_HASH_SEED + i) >>> 0;
+      const taken = new Set();
+      const unique = words.every(word => {
+        const slot = this._keywordHash(word, seed) & mask;
+        if (taken.has(slot)) {
+          return false;
+        }
+        taken.add(slot);
+        return true;
+      });
+      if (unique) {
+        return seed;
+      }
+    }
+    return null;
+  },
+
+  /**
+   * FNV-1a hash of the word with the seed, with the high bits folded into
+   * the low ones, as in `Tokenizer::lookupKeyword_`.
+   */
+  _keywordHash(word, seed) {
+    let hash = seed >>> 0;
+    for (let i = 0; i < word.length; i++) {
+      hash = Math.imul(hash ^ word.charCodeAt(i), KEYWORD_HASH_PRIME) >>> 0;
+    }
+    return (hash ^ (hash >>> 16)) >>> 0;
+  },
+
+  /**
+   * Generates first bytes of each lex rule for the regex lexer: a rule
+   * is tried at the cursor only if it can start with the current byte.
+   * Rules which the DFA parser doesn't support, or which can match the
+   * empty string, can start with any byte.
+   */
+  generateLexRulesFirstBytes() {
+    if (this._usesDFALexer()) {
+      this.writeData('LEX_RULES_FIRST_BYTES', '');
+      return;
+    }
+
+    const keywordGroups = this._keywordGroups();
+
+    const rows = this._grammar.getLexGrammar().getRules().map((lexRule, index) => {
+      let bytes = null;
+
+      // A keyword group starts with the first bytes of its words.
+      const group = keywordGroups.byRule[index];
+      if (group) {
+        bytes = new Array(256).fill(false);
+        group.words.forEach((_rule, word) => {
+          bytes[word.charCodeAt(0)] = true;
+        });
+      } else {
+        try {
+          const first = RegExpParser.firstBytes(
+            RegExpParser.parse(lexRule.getRawMatcher(), {
+              caseInsensitive: lexRule.isCaseInsensitive(),
+            })
+          );
+          if (!first.nullable) {
+            bytes = first.bytes;
+          }
+        } catch (e) {
+          /* not supported, any byte */
+        }
+      }
+
+      // 256-bit set as 4 x 64-bit words, written in hex digits.
+      const words = [];
+      for (let word = 0; word < 4; word++) {
+        let hex = '';
+        for (let nibble = 15; nibble >= 0; nibble--) {
+          let digit = 0;
+          for (let bit = 0; bit < 4; bit++) {
+            if (!bytes || bytes[word * 64 + nibble * 4 + bit]) {
+              digit |= 1 << bit;
+            }
+          }
+          hex += digit.toString(16);
+        }
+        words.push(`0x${hex}ull`);
+      }
+
+      return `{${words.join(', ')}}`;
+    });
+
+    this.writeData(
+      'LEX_RULES_FIRST_BYTES',
+      `static constexpr uint64_t lexRulesFirstBytes_[${rows.length}][4] = ` +
+        `{\n    ${rows.join(',\n    ')}\n  };`,
+    );
+  },
+
+  /**
+   * Narrowest C++ integer type for values up to `max`.
+   */
+  _cppIntType(max, signed = false) {
+    for (const bits of [8, 16, 32]) {
+      if (max < Math.pow(2, signed ? bits - 1 : bits)) {
+        return `${signed ? '' : 'u'}int${bits}_t`;
+      }
+    }
+    return `${signed ? '' : 'u'}int64_t`;
+  },
+
+  /**
+   * Converts a string into a C++ string literal, the non-printable bytes
+   * are escaped in octal.
+   */
+  _toCppString(string) {
+    const escaped = Buffer.from(string, 'utf8')
+      .toString('latin1')
+      .replace(/[\\"]/g, '\\$&')
+      .replace(/[^\x20-\x7e]/g, c =>
+        '\\' + ('00' + c.charCodeAt(0).toString(8)).slice(-3)
+      );
+    return `"${escaped}"`;
+  },
+
+  /**
+   * Converts an array of numbers into a C++ array initializer.
+   */
+  _toCppArray(data, perLine = 16) {
+    const lines = [];
+    for (let i = 0; i < data.length; i += perLine) {
+      lines.push(data.slice(i, i + perLine).join(', '));
+    }
+    return `{\n    ${lines.join(',\n    ')}\n  }`;
+  },
+
+  /**
+   * Lex rules by start condition, as constexpr spans in the flat
+   * table of rule indices.
    */
   generateLexRulesByStartConditions() {
     const lexGrammar = this._grammar.getLexGrammar();
     const lexRulesByConditions = lexGrammar.getRulesByStartConditions();
-    const result = [];
 
     const tokenizerStates = Object.keys(lexRulesByConditions);
     this.writeData('TOKENIZER_STATES', tokenizerStates.join(',\n  '));
 
-    for (const condition in lexRulesByConditions) {
-      result[`TokenizerState::${condition}`] = lexRulesByConditions[condition].map(lexRule =>
-        lexGrammar.getRuleIndex(lexRule)
-      );
+    const keywordGroups = this._keywordGroups();
+
+    const indices = [];
+    const spans = tokenizerStates.map(condition => {
+      const offset = indices.length;
+      lexRulesByConditions[condition].forEach(lexRule => {
+        const index = lexGrammar.getRuleIndex(lexRule);
+        // Keyword groups are matched at their first rule.
+        if (keywordGroups.byRule[index] !== null) {
+          indices.push(index);
+        }
+      });
+      return `{${offset}, ${indices.length - offset}}`;
+    });
+
+    if (indices.length === 0) {
+      indices.push(0);
     }
 
-    this.writeData(
-      'LEX_RULES_BY_START_CONDITIONS',
-      `${this._toCppMap(result, '', 'raw')}`,
+    const indexType = this._cppIntType(
+      lexGrammar.getRules().length,
     );
+
+    this.writeData('LEX_RULES_BY_START_CONDITIONS', [
+      `static constexpr ${indexType} lexRulesIndices_[${indices.length}] = ` +
+        `${this._toCppArray(indices)};`,
+      `static constexpr LexRulesSpan ` +
+        `lexRulesByStartConditions_[${spans.length}] = ` +
+        `{${spans.join(', ')}};`,
+    ].join('\n  '));
   },
 
   /**
@@ -338,7 +1254,8 @@ const CppParserGeneratorTrait = {
       .replace(/yytext/g, 'tokenizer.yytext')
       .replace(/\b__\b/g, 'auto __');
 
-    const tokenRe = /return\s+([^;]+?);/g;
+    // A quoted token may contain a `;` itself, e.g. "';'".
+    const tokenRe = /return\s+("(?:[^"\\]|\\.)*"|'(?:[^'\\]|\\.)*'|[^;]+?);/g;
 
     return code.replace(tokenRe, (_match, token) => {
       token = token.replace(/^['"]|['"]$/g, '');
@@ -411,18 +1328,44 @@ const CppParserGeneratorTrait = {
   generateTokenTypes() {
     const tokenTypes = Object.keys(this._tokens).map(token => {
       const index = this._tokens[token];
-      if (this._grammar._tokensMap.hasOwnProperty(token)) {
-        return `${token} = ${index}`;
-      }
-      this._terminalsMap[token] = index;
-      if (token === '$') {
-        return `__EOF = ${index}`;
+      if (!this._grammar._tokensMap.hasOwnProperty(token)) {
+        this._terminalsMap[token] = index;
       }
-      return `TOKEN_TYPE_${index} = ${index}`;
+      return `${this._cppTokenType(token)} = ${index}`;
     });
     this.writeData('TOKEN_TYPES', tokenTypes.join(',\n  '));
   },
 
+  /**
+   * Generates the `NonTerminal` enum, for `parseItems`: the non-terminals
+   * with the values on the values stack (not propagating a token), which
+   * are valid C++ identifiers.
+   */
+  generateNonTerminals() {
+    const nonTerminals = Object.keys(this._nonTerminals)
+      .filter(symbol =>
+        /^[a-zA-Z_]\w*$/.test(symbol) &&
+        !this._derivesPropagatingToken(symbol)
+      )
+      .map(symbol => `${symbol} = ${this._nonTerminals[symbol]}`);
+
+    this.writeData('NON_TERMINALS', nonTerminals.join(',\n  '));
+  },
+
+  /**
+   * Name of the token in the `TokenType` enum: named tokens as is, the
+   * raw literal tokens by their index.
+   */
+  _cppTokenType(token) {
+    if (this._grammar._tokensMap.hasOwnProperty(token)) {
+      return token;
+    }
+    if (token === '$') {
+      return '__EOF';
+    }
+    return `TOKEN_TYPE_${this._tokens[token]}`;
+  },
+
   /**
    * C++ specific handler declarations.
    */
@@ -430,16 +1373,34 @@ const CppParserGeneratorTrait = {
     const handlers = this._generateHandlers(
       this._productionHandlers,
       '_handler',
-      'void'
+      'inline void'
     );
     this.writeData('PRODUCTION_HANDLERS', handlers.join('\n\n'));
+
+    // Dispatch by the production number, the pass-through productions
+    // leaving the value on the stack have no case.
+    const actions = [];
+    this._productionActions.forEach((action, number) => {
+      if (action) {
+        actions.push(`case ${number}: ${action} break;`);
+      }
+    });
+    actions.push('default: break;');
+
+    this.writeData('PRODUCTION_ACTIONS', actions.join('\n    '));
   },
 
+  /**
+   * Handler functions; the production handlers are sparse, by the number
+   * of the production.
+   */
   _generateHandlers(handlers, name, returnType) {
-    return handlers.map(({args, action}, index) => {
-      return `${returnType} ${name}${index + 1}` +
-        `(${args}) {\n${action}\n}`
-    });
+    return handlers
+      .map(({args, action}, index) => {
+        return `${returnType} ${name}${index + 1}` +
+          `(${args}) {\n${action}\n}`
+      })
+      .filter(handler => handler);
   },
 };
 
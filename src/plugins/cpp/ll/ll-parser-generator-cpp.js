@@ -0,0 +1,373 @@
+/**
+ * The MIT License (MIT)
+ * Copyright (c) 2015-present Dmitry Soshnikov <dmitry.soshnikov@gmail.com>
+ */
+
+const LLParserGeneratorDefault = require(ROOT + 'll/ll-parser-generator-default').default;
+const CppParserGeneratorTrait = require('../cpp-parser-generator-trait');
+
+import fs from 'fs';
+import path from 'path';
+
+/**
+ * Generic C++ template for LL(1) parsers.
+ */
+const CPP_LL_PARSER_TEMPLATE = fs.readFileSync(
+  `${__dirname}/../templates/ll.template.h`,
+  'utf-8',
+);
+
+/**
+ * LL parser generator for C++.
+ */
+export default class LLParserGeneratorCpp extends LLParserGeneratorDefault {
+
+  /**
+   * Instance constructor.
+   */
+  constructor({
+    grammar,
+    outputFile,
+    options = {},
+  }) {
+    super({grammar, outputFile, options})
+      .setTemplate(CPP_LL_PARSER_TEMPLATE);
+
+    if (Object.keys(this._table.getConflicts()).length > 0) {
+      throw new Error(
+        `C++ plugin: the LL(1) grammar has conflicts, see the --table.`
+      );
+    }
+
+    this._lexHandlers = [];
+    this._productionHandlers = [];
+    this._productionActions = [];
+    this._tokenTypes = [];
+    this._terminalsMap = {};
+    this._terminalsIndexMap = {};
+
+    this._parserClassName = path.basename(
+      outputFile,
+      path.extname(outputFile),
+    );
+
+    // Trait provides methods for lex and production handlers.
+    Object.assign(this, CppParserGeneratorTrait);
+  }
+
+  /**
+   * Generates parser code.
+   */
+  generateParserData() {
+    this.generateNamespace();
+    this.generateOptions();
+    this.generateModuleInclude();
+    this.generateBuiltInTokenizer();
+    this.generateTokenTypes();
+    this.generateLexRules();
+    this.generateLexRulesByStartConditions();
+    this.generateLexDFA();
+    this.generateLexRulesFirstBytes();
+    this.generateLexRulesMatchers();
+    this.generateLexHandlers();
+    this.generateLLSemanticActions();
+    this.generateLLTables();
+    this.generateRecursiveDescent();
+    this.generateProductionHandlers();
+    this.generateParserClassName(this._parserClassName);
+    this.generateLLParsedResult();
+  }
+
+  /**
+   * Builds the handlers of the productions, shared with the LR parsers:
+   * an LL parser runs the semantic action of a production when its RHS is
+   * parsed, with the same arguments on the stacks.
+   */
+  generateLLSemanticActions() {
+    this._grammar.getProductions().forEach(production => {
+      this.buildSemanticAction(production);
+    });
+  }
+
+  /**
+   * Generates the LL(1) table (the production number per non-terminal and
+   * token), and the reversed RHS of the productions, for the table driver.
+   */
+  generateLLTables() {
+    const productions = this._grammar.getProductions();
+    const nonTerminalsCount = Object.keys(this._nonTerminals).length;
+    const tokensCount = Object.keys(this._tokens).length;
+
+    this.writeData('NON_TERMINALS_COUNT', nonTerminalsCount);
+    this.writeData('TOKENS_COUNT', tokensCount);
+    this.writeData('PRODUCTIONS_COUNT', productions.length);
+
+    this.writeData('PRODUCTION_TYPE', this._cppIntType(productions.length));
+    this.writeData(
+      'STACK_SYMBOL_TYPE',
+      this._cppIntType(
+        Math.max(nonTerminalsCount + tokensCount + 1, productions.length + 1),
+        /* signed */ true,
+      ),
+    );
+
+    this.writeData(
+      'START_SYMBOL',
+      this.getEncodedNonTerminal(this._grammar.getStartSymbol()),
+    );
+
+    const table = this.generateParseTableData();
+    const rows = Object.keys(this._nonTerminals).map(symbol => {
+      const encoded = this._nonTerminals[symbol];
+      const entries = new Array(tokensCount).fill(0);
+      const row = table[encoded] || {};
+
+      Object.keys(row).forEach(token => {
+        entries[Number(token) - nonTerminalsCount] = Number(row[token]);
+      });
+
+      return `// ${symbol}\n    ${entries.join(', ')}`;
+    });
+
+    this.writeData('TABLE', `{\n    ${rows.join(',\n    ')}\n  }`);
+
+    // The handler of a right-recursive production keeps the token before
+    // its tail (`KEEP_TOKEN`, after all the symbols).
+    const keepToken = nonTerminalsCount + tokensCount;
+
+    const rhs = [];
+    const encodedProductions = productions.map(production => {
+      const number = production.getNumber();
+      const symbols = this._rhsSymbols(production)
+        .map(symbol => this.getEncodedSymbol(symbol));
+      const hasAction = Boolean(this._productionActions[number]);
+      const keepsToken = Boolean(this._productionHandlers[number]) &&
+        this._isTailRecursive(production);
+      if (keepsToken) {
+        symbols.splice(symbols.length - 1, 0, keepToken);
+      }
+      symbols.reverse();
+      const offset = rhs.length;
+      rhs.push(...symbols);
+      return `{${offset}, ${symbols.length}, ${hasAction}, ${keepsToken}}`;
+    });
+
+    // Productions are 1-based.
+    encodedProductions.unshift('{0, 0, false, false}');
+
+    if (rhs.length === 0) {
+      rhs.push(0);
+    }
+
+    this.writeData(
+      'PRODUCTIONS',
+      `{\n    ${encodedProductions.join(',\n    ')}\n  }`,
+    );
+    this.writeData('RHS_COUNT', rhs.length);
+    this.writeData('RHS', this._toCppArray(rhs));
+  }
+
+  /**
+   * Generates the recursive-descent driver (`--driver coded`): a function
+   * per non-terminal, with a `switch` on the lookahead token, each case
+   * parsing the RHS of the predicted production in line, and calling its
+   * handler. A right-recursive tail (`list : item list`) is a loop, the
+   * handlers of which are deferred until the list ends, so the lists do
+   * not grow the C++ stack. A deferred handler keeps the last token of its
+   * item, restored as the `yytext` when it runs.
+   *
+   * Example:
+   *
+   *   // E' -> "+" T E'
+   *   case TokenType::TOKEN_TYPE_7:
+   *     if (!shift_(token)) return false;
+   *     if (!parse2_(token)) return false;
+   *     pending_.push_back({2, shiftedToken_});
+   *     continue;
+   */
+  generateRecursiveDescent() {
+    if (!this._usesCodedDriver()) {
+      this.writeData('CODED_DECLARATIONS', '');
+      this.writeData('CODED_DRIVER', '');
+      return;
+    }
+
+    const table = this._table.get();
+
+    const declarations = [];
+    const definitions = [];
+    const predicts = [];
+
+    Object.keys(this._nonTerminals).forEach(symbol => {
+      const encoded = this._nonTerminals[symbol];
+      const row = table[symbol] || {};
+
+      // Tokens predicting each production.
+      const tokensOf = {};
+      Object.keys(row).forEach(token => {
+        (tokensOf[row[token]] = tokensOf[row[token]] || []).push(token);
+      });
+
+      const productions = this._grammar.getProductionsForSymbol(symbol)
+        .filter(production => tokensOf.hasOwnProperty(production.getNumber()));
+
+      const isLoop = productions.some(production =>
+        this._isTailRecursive(production)
+      );
+
+      const cases = productions.map(production => {
+        const number = production.getNumber();
+        const labels = tokensOf[number].map(token =>
+          `case TokenType::${this._cppTokenType(token)}:`
+        );
+        const lines = this._rhsSymbols(production).map((rhsSymbol, index) => {
+          const rhsEncoded = this.getEncodedSymbol(rhsSymbol);
+
+          if (this._grammar.isNonTerminal(rhsSymbol)) {
+            if (isLoop && index === production.getRHS().length - 1 &&
+                rhsSymbol === symbol) {
+              return null;
+            }
+            return `if (!parse${rhsEncoded}_(token)) return false;`;
+          }
+
+          // The first token is the lookahead which predicted the production.
+          return index === 0
+            ? 'if (!shift_(token)) return false;'
+            : `if (!expect_(token, TokenType::${
+              this._cppTokenType(rhsSymbol)
+            })) return false;`;
+        }).filter(line => line !== null);
+
+        const action = this._productionActions[number];
+
+        if (isLoop && this._isTailRecursive(production)) {
+          if (action) {
+            lines.push(`pending_.push_back({${number}, shiftedToken_});`);
+          }
+          lines.push('continue;');
+        } else {
+          if (action) {
+            if (this._productionHandlers[number]) {
+              lines.push(
+                'tokenizer.yytext = tokenizer.getTokenText(shiftedToken_);'
+              );
+            }
+            lines.push(action);
+          }
+          lines.push(isLoop ? 'break;' : 'return true;');
+        }
+
+        return `${labels.join('\n  ')}\n` +
+          `    // ${production.toFullString()}\n` +
+          `    ${lines.join('\n    ')}`;
+      });
+
+      // The stack macros of the actions refer to the parser as well.
+      const usesParser = productions.some(production =>
+        /\bparser\b|\b(DROP_[TV]|PUSH_DEFAULT_V)\(/.test(
+          this._productionActions[production.getNumber()] || ''
+        )
+      );
+
+      const body = [];
+      if (usesParser) {
+        body.push('[[maybe_unused]] auto& parser = *this;');
+      }
+
+      const dispatch =
+        `switch (token.type) {\n  ${cases.join('\n  ')}\n` +
+        `  default:\n    syntaxError_(token, ${encoded});\n` +
+        `    return false;\n}`;
+
+      if (isLoop) {
+        body.push(
+          'auto depth = pending_.size();',
+          `for (;;) {\n  ${dispatch.replace(/\n/g, '\n  ')}\n  break;\n}`,
+          'resume_(depth);',
+          'return true;'
+        );
+      } else {
+        body.push(dispatch);
+      }
+
+      declarations.push(`bool parse${encoded}_(Token& token);`);
+      definitions.push(
+        `// ${symbol}\ninline bool yyparse::parse${encoded}_(Token& token) {\n` +
+        `  ${body.join('\n').replace(/\n/g, '\n  ')}\n}`
+      );
+
+      const predicted = Object.keys(row).map(token =>
+        `case ${this._tokens[token]}:`
+      );
+      predicts.push(
+        `case ${encoded}:\n      switch (token) {\n` +
+        `        ${predicted.join('\n        ')}\n` +
+        '          return true;\n' +
+        '      }\n' +
+        '      return false;'
+      );
+    });
+
+    const start = this.getEncodedNonTerminal(this._grammar.getStartSymbol());
+
+    this.writeData('CODED_DECLARATIONS', declarations.join('\n  '));
+    this.writeData('CODED_DRIVER', `
+// ------------------------------------------------------------------
+// Recursive-descent driver (\`--driver coded\`).
+
+inline bool yyparse::run_(Token& token) {
+  return parse${start}_(token);
+}
+
+// clang-format off
+${definitions.join('\n\n')}
+// clang-format on
+
+inline bool yyparse::predicts_(int symbol, int token) {
+  switch (symbol) {
+    // clang-format off
+    ${predicts.join('\n    ')}
+    // clang-format on
+  }
+  return false;
+}
+`);
+  }
+
+  /**
+   * Whether the production ends with its LHS, `list : item list`.
+   */
+  _isTailRecursive(production) {
+    if (production.isEpsilon()) {
+      return false;
+    }
+    const rhs = production.getRHS();
+    return rhs.length > 1 &&
+      rhs[rhs.length - 1].getSymbol() === production.getLHS().getSymbol();
+  }
+
+  /**
+   * Symbols of the RHS (none for an epsilon production).
+   */
+  _rhsSymbols(production) {
+    if (production.isEpsilon()) {
+      return [];
+    }
+    return production.getRHS().map(symbol => symbol.getSymbol());
+  }
+
+  /**
+   * Generates final parsed result: the value of the start symbol.
+   */
+  generateLLParsedResult() {
+    const startSymbol = this._grammar.getStartSymbol();
+
+    // A propagated token is a view, which is converted to the `Value`.
+    const result = this._derivesPropagatingToken(startSymbol)
+      ? 'auto result = Value(tokensStack.back()); tokensStack.pop_back();'
+      : 'auto result = std::move(valuesStack.back()); valuesStack.pop_back();';
+
+    this.writeData('PARSED_RESULT', result);
+  }
+};
@@ -35,6 +35,7 @@ export default class LRParserGeneratorCpp extends LRParserGeneratorDefault {
 
     this._lexHandlers = [];
     this._productionHandlers = [];
+    this._productionActions = [];
     this._tokenTypes = [];
     this._terminalsMap = {};
     this._terminalsIndexMap = {};
@@ -53,13 +54,18 @@ export default class LRParserGeneratorCpp extends LRParserGeneratorDefault {
    */
   generateParserData() {
     this.generateNamespace();
+    this.generateOptions();
     this.generateModuleInclude();
     this.generateCaptureLocations();
     this.generateBuiltInTokenizer();
     this.generateTokenTypes();
+    this.generateNonTerminals();
     this.generateTokensTable();
     this.generateLexRules();
     this.generateLexRulesByStartConditions();
+    this.generateLexDFA();
+    this.generateLexRulesFirstBytes();
+    this.generateLexRulesMatchers();
     this.generateLexHandlers();
     this.generateProductions();
     this.generateParseTable();
@@ -0,0 +1,630 @@
+/**
+ * LL(1) parser for C++ generated by the Syntax tool.
+ *
+ * https://www.npmjs.com/package/syntax-cli
+ *
+ *   npm install -g syntax-cli
+ *
+ *   syntax-cli --help
+ *
+ * To regenerate run:
+ *
+ *   syntax-cli \
+ *     --grammar ~/path-to-grammar-file \
+ *     --mode LL1 \
+ *     --output ~/ParserClassName.h
+ */
+#ifndef __Syntax_LL_Parser_h
+#define __Syntax_LL_Parser_h
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-private-field"
+#endif
+
+// ------------------------------------
+// Generator options.
+
+// clang-format off
+{{{GENERATOR_OPTIONS}}}
+// clang-format on
+
+#include <assert.h>
+#include <algorithm>
+#include <array>
+#if SYNTAX_PARSER_STATS
+#include <chrono>
+#endif
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#if !SYNTAX_LEXER_DFA
+#include <regex>
+#endif
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#if SYNTAX_LEXER_SIMD && defined(__AVX2__)
+#define SYNTAX_LEXER_SIMD_AVX2 1
+#include <immintrin.h>
+#elif SYNTAX_LEXER_SIMD && (defined(__SSE2__) || defined(_M_X64))
+#define SYNTAX_LEXER_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif SYNTAX_LEXER_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+#define SYNTAX_LEXER_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// ------------------------------------
+// Module include prologue.
+//
+// Should include at least value/result type:
+//
+// type Value = <...>;
+//
+// Or struct Value { ... };
+//
+// Can also include parsing hooks:
+//
+//   void onParseBegin(const Parser& parser, std::string_view str) {
+//     ...
+//   }
+//
+//   void onParseBegin(const Parser& parser, const Value& result) {
+//     ...
+//   }
+//
+// clang-format off
+{{{MODULE_INCLUDE}}}  // clang-format on
+
+namespace syntax {
+
+/**
+ * Tokenizer class.
+ */
+// clang-format off
+{{{TOKENIZER}}}
+// clang-format on
+
+#define POP_V()                         \
+  std::move(parser.valuesStack.back()); \
+  parser.valuesStack.pop_back()
+
+#define POP_T()                         \
+  std::move(parser.tokensStack.back()); \
+  parser.tokensStack.pop_back()
+
+#define PUSH_VR() parser.valuesStack.emplace_back(std::move(__))
+#define PUSH_TR() parser.tokensStack.emplace_back(std::move(__))
+
+// The result of a production without a semantic action: the default
+// `Value`, which then has to be default-constructible.
+
+#define PUSH_DEFAULT_V()                                          \
+  static_assert(std::is_default_constructible_v<Value>,           \
+                "A production without a semantic action needs a " \
+                "default-constructible Value");                   \
+  parser.valuesStack.emplace_back()
+
+// In-place handler arguments (`--handler-args inplace`): the n-th entry
+// from the top of a stack, and the truncation of a stack after the action.
+
+#define STACK_V(n) parser.valuesStack[parser.valuesStack.size() - (n)]
+#define STACK_T(n) parser.tokensStack[parser.tokensStack.size() - (n)]
+
+#define DROP_V(n)                                             \
+  parser.valuesStack.erase(parser.valuesStack.end() - (n), \
+                           parser.valuesStack.end())
+#define DROP_T(n) parser.tokensStack.resize(parser.tokensStack.size() - (n))
+
+/**
+ * Integer types of the production numbers, and of the entries of the
+ * derivation stack: the encoded symbols, and the semantic actions to run,
+ * as the negated production numbers.
+ */
+// clang-format off
+using ProductionIndex = {{{PRODUCTION_TYPE}}};
+using StackSymbol = {{{STACK_SYMBOL_TYPE}}};
+// clang-format on
+
+// clang-format off
+class {{{PARSER_CLASS_NAME}}};
+// clang-format on
+
+using yyparse = {{{PARSER_CLASS_NAME}}};
+
+#if !SYNTAX_PARSER_CODED
+/**
+ * Encoded production: its reversed RHS in `yyparse::rhs_`, pushed onto the
+ * derivation stack on the prediction, and whether it has a semantic action
+ * (dispatched by the number, `yyparse::handle_`). The handler of a right
+ * recursive production (`list : item list`) keeps the last token of its
+ * item, saved before the tail is derived.
+ */
+struct LLProduction {
+  uint32_t rhsOffset;
+  uint32_t rhsLength;
+  bool hasAction;
+  bool keepsToken;
+};
+#endif
+
+/**
+ * Result of `tryParse`: the value, or the syntax error record.
+ */
+struct ParseResult {
+  std::optional<Value> value;
+  SyntaxError error;
+
+  bool ok() const { return error.kind == SyntaxErrorKind::None; }
+};
+
+// ------------------------------------------------------------------
+// Parser.
+
+/**
+ * Parser class.
+ *
+ * A predictive parser: the production of a non-terminal is chosen by the
+ * lookahead token, and the semantic actions run as the productions end, in
+ * the same order as in the LR parsers (so the same handlers are used). By
+ * default the parser interprets the LL(1) table with a derivation stack;
+ * the coded driver (`--driver coded`) is a recursive descent, a function
+ * per non-terminal, without the table.
+ *
+ * Thread safety: the parsing and lexing tables are immutable, constant
+ * initialized data shared by all instances, so parsers can run concurrently
+ * in different threads. An instance itself is not synchronized: use one
+ * parser per thread.
+ */
+// clang-format off
+class {{{PARSER_CLASS_NAME}}} {
+  // clang-format on
+ public:
+  /**
+   * Parser instances are reusable: each parse resets the state, keeping
+   * the capacity of the stacks and of the tokenizer buffers.
+   *
+   * The stacks are pre-sized to the `SYNTAX_PARSER_STACK_RESERVE` depth.
+   */
+  // clang-format off
+  {{{PARSER_CLASS_NAME}}}() {
+    // clang-format on
+    reserve(SYNTAX_PARSER_STACK_RESERVE);
+  }
+
+  /**
+   * Resets the parsing state, keeping the allocated capacity. Called at
+   * the beginning of each parse.
+   */
+  void reset() {
+    valuesStack.clear();
+    tokensStack.clear();
+#if SYNTAX_PARSER_CODED
+    pending_.clear();
+#else
+    symbolsStack_.clear();
+    keptTokens_.clear();
+#endif
+  }
+
+  /**
+   * Reserves the stacks for the parsing depth.
+   */
+  void reserve(size_t depth) {
+    valuesStack.reserve(depth);
+    tokensStack.reserve(depth);
+#if SYNTAX_PARSER_CODED
+    pending_.reserve(depth);
+#else
+    symbolsStack_.reserve(depth);
+#endif
+  }
+
+  /**
+   * Parsing values stack.
+   */
+  std::vector<Value> valuesStack;
+
+  /**
+   * Token values stack: views into the parsing string.
+   */
+  std::vector<std::string_view> tokensStack;
+
+  /**
+   * Tokenizer.
+   */
+  Tokenizer tokenizer;
+
+  /**
+   * Parses a string. The string is not copied, and should outlive
+   * the parsing.
+   *
+   * Throws `SyntaxErrorException` on syntax errors.
+   */
+  Value parse(std::string_view str) {
+    tokenizer.initString(str);
+
+    return valueOrThrow_(parse_(str));
+  }
+
+  /**
+   * Parses a string, returning the syntax error instead of throwing it (the
+   * exceptions of the semantic actions are still propagated).
+   */
+  ParseResult tryParse(std::string_view str) {
+    tokenizer.initString(str);
+
+    return parse_(str);
+  }
+
+  /**
+   * Parses an input stream incrementally, reading it in chunks, without
+   * keeping the whole input in memory (see `Tokenizer::initStream`).
+   *
+   * Token values (`$1`, etc) are views into the sliding window, which are
+   * valid during the semantic action only, so values should own the
+   * strings they keep.
+   */
+  Value parseStream(std::istream& stream,
+                    size_t chunkSize = Tokenizer::DEFAULT_CHUNK_SIZE) {
+    tokenizer.initStream(stream, chunkSize);
+    tokenizer.retainViews(&tokensStack);
+
+    return valueOrThrow_(parse_(std::string_view{}));
+  }
+
+  /**
+   * Tokens expected at a syntax error: the tokens predicting a production
+   * of the expected non-terminal, or the expected token.
+   */
+  std::vector<TokenType> expectedTokens(const SyntaxError& error) const {
+    std::vector<TokenType> tokens;
+    if (error.state < 0) {
+      return tokens;
+    }
+    if (error.state >= (int)NON_TERMINALS_COUNT) {
+      tokens.push_back((TokenType)error.state);
+      return tokens;
+    }
+    for (size_t column = 0; column < TOKENS_COUNT; column++) {
+      if (predicts_(error.state, (int)(NON_TERMINALS_COUNT + column))) {
+        tokens.push_back((TokenType)(NON_TERMINALS_COUNT + column));
+      }
+    }
+    return tokens;
+  }
+
+  /**
+   * Syntax errors of the last parse: at most one.
+   */
+  const std::vector<SyntaxError>& syntaxErrors() const { return errors_; }
+
+  /**
+   * Size of the static parsing and lexing tables, in bytes (the coded
+   * driver has no parsing tables).
+   */
+  static constexpr size_t tablesSize() {
+    return
+#if !SYNTAX_PARSER_CODED
+        sizeof(table_) + sizeof(productions_) + sizeof(rhs_) +
+#endif
+        Tokenizer::tablesSize();
+  }
+
+  /**
+   * Message of a syntax error of the last parse, showing the source line.
+   */
+  std::string formatError(const SyntaxError& error) const {
+    return tokenizer.formatError(error);
+  }
+
+ private:
+  /**
+   * Parses the initialized tokenizer. The `str` is passed to the
+   * `onParseBegin` hook (empty when streaming).
+   */
+  ParseResult parse_([[maybe_unused]] std::string_view str) {
+    // clang-format off
+    {{{ON_PARSE_BEGIN_CALL}}}
+    // clang-format on
+
+    reset();
+    errors_.clear();
+
+    Token token;
+    if (!tokenizer.tryGetNextToken(token)) {
+      syntaxError_(token, -1);
+      return failed_();
+    }
+    shiftedToken_ = token;
+
+    if (!run_(token)) {
+      return failed_();
+    }
+
+    if (token.type != TokenType::__EOF) {
+      syntaxError_(token, (int)TokenType::__EOF);
+      return failed_();
+    }
+
+    // clang-format off
+    {{{PARSED_RESULT}}}
+    // clang-format on
+
+    // clang-format off
+    {{{ON_PARSE_END_CALL}}}
+    // clang-format on
+
+    ParseResult parsed;
+    parsed.value.emplace(std::move(result));
+    return parsed;
+  }
+
+#if SYNTAX_PARSER_CODED
+  /**
+   * Parses the start symbol from the `token` (recursive descent, defined
+   * after the handlers). Returns false on a syntax error.
+   */
+  bool run_(Token& token);
+
+  /**
+   * Parsing functions of the non-terminals, by the encoded symbol. The
+   * `token` is the lookahead, which is left after the parsed non-terminal.
+   */
+  // clang-format off
+  {{{CODED_DECLARATIONS}}}
+  // clang-format on
+
+  /**
+   * Whether the token predicts a production of the non-terminal.
+   */
+  static bool predicts_(int symbol, int token);
+
+  /**
+   * Runs the semantic actions of the productions deferred by the loops of
+   * the right-recursive non-terminals, down to the `depth`. Each action
+   * sees the `yytext` of the last token of its own item.
+   */
+  void resume_(size_t depth) {
+    while (pending_.size() > depth) {
+      auto action = pending_.back();
+      pending_.pop_back();
+
+      tokenizer.yytext = tokenizer.getTokenText(action.shiftedToken);
+      handle_(*this, action.productionNumber);
+    }
+  }
+#else
+  /**
+   * Main parsing loop: the symbol on top of the derivation stack is either
+   * matched with the lookahead token, or replaced with the RHS of the
+   * production chosen in the table by the lookahead. The semantic action
+   * of a production runs when its RHS is popped.
+   */
+  bool run_(Token& token) {
+    symbolsStack_.push_back(START_SYMBOL);
+
+    while (!symbolsStack_.empty()) {
+      auto symbol = symbolsStack_.back();
+      symbolsStack_.pop_back();
+
+      // End of a production, run its semantic action.
+      if (symbol < 0) {
+        if (productions_[-symbol].keepsToken) {
+          tokenizer.yytext = tokenizer.getTokenText(keptTokens_.back());
+          keptTokens_.pop_back();
+        } else {
+          tokenizer.yytext = tokenizer.getTokenText(shiftedToken_);
+        }
+        handle_(*this, -symbol);
+        continue;
+      }
+
+      // The item of a right-recursive production is parsed.
+      if (symbol == KEEP_TOKEN) {
+        keptTokens_.push_back(shiftedToken_);
+        continue;
+      }
+
+      // A token, matched with the lookahead.
+      if (symbol >= (int)NON_TERMINALS_COUNT) {
+        if (!expect_(token, (TokenType)symbol)) {
+          return false;
+        }
+        continue;
+      }
+
+      // A non-terminal, derived by the predicted production.
+      auto column = (int)token.type - (int)NON_TERMINALS_COUNT;
+      auto productionNumber = table_[symbol * TOKENS_COUNT + column];
+
+      if (productionNumber == 0) {
+        syntaxError_(token, symbol);
+        return false;
+      }
+
+      const auto& production = productions_[productionNumber];
+
+      if (production.hasAction) {
+        symbolsStack_.push_back(-(StackSymbol)productionNumber);
+      }
+      symbolsStack_.insert(symbolsStack_.end(), rhs_ + production.rhsOffset,
+                           rhs_ + production.rhsOffset + production.rhsLength);
+    }
+
+    return true;
+  }
+
+  /**
+   * Whether the token predicts a production of the non-terminal.
+   */
+  static constexpr bool predicts_(int symbol, int token) {
+    return table_[symbol * TOKENS_COUNT + token - NON_TERMINALS_COUNT] != 0;
+  }
+#endif
+
+  /**
+   * Shifts the lookahead token, which is known to be expected, and reads
+   * the next one.
+   */
+  bool shift_(Token& token) {
+    tokensStack.push_back(tokenizer.getTokenText(token));
+    shiftedToken_ = token;
+
+    if (!tokenizer.tryGetNextToken(token)) {
+      syntaxError_(token, -1);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Shifts the lookahead token if it's of the `type`, otherwise records
+   * the syntax error.
+   */
+  bool expect_(Token& token, TokenType type) {
+    if (token.type != type) {
+      syntaxError_(token, (int)type);
+      return false;
+    }
+    return shift_(token);
+  }
+
+  /**
+   * Records the syntax error on the unexpected token, with the expected
+   * symbol (a non-terminal, or a token) as the state.
+   */
+  void syntaxError_(const Token& token, int symbol) {
+    auto kind = SyntaxErrorKind::UnexpectedToken;
+    if (token.type == TokenType::__EMPTY) {
+      kind = SyntaxErrorKind::UnexpectedInput;
+    } else if (token.type == TokenType::__EOF) {
+      kind = SyntaxErrorKind::UnexpectedEnd;
+    }
+
+    errors_.push_back(SyntaxError{kind, token.type, symbol, token.startOffset,
+                                  token.endOffset()});
+  }
+
+  /**
+   * Result of the failed parse.
+   */
+  ParseResult failed_() {
+    ParseResult parsed;
+    parsed.error = errors_.front();
+    return parsed;
+  }
+
+  /**
+   * Value of the successful parse, or throws the syntax error.
+   */
+  Value valueOrThrow_(ParseResult&& parsed) {
+    if (!parsed.ok()) {
+      throw SyntaxErrorException(formatError(parsed.error), parsed.error);
+    }
+    return std::move(*parsed.value);
+  }
+
+  /**
+   * Semantic action of the production: calls its handler, or, for the
+   * productions passing a value through (`$$ = $1`), only drops the other
+   * arguments from the stacks (defined after the handlers).
+   */
+  static void handle_(yyparse& parser, int productionNumber);
+
+  /**
+   * The last shifted token, the `yytext` of the semantic actions.
+   */
+  Token shiftedToken_{};
+
+  /**
+   * Syntax errors of the last parse.
+   */
+  std::vector<SyntaxError> errors_;
+
+#if SYNTAX_PARSER_CODED
+  /**
+   * Deferred semantic action: the production, and the last token shifted
+   * by its item.
+   */
+  struct PendingAction_ {
+    ProductionIndex productionNumber;
+    Token shiftedToken;
+  };
+
+  /**
+   * Productions with the deferred semantic actions.
+   */
+  std::vector<PendingAction_> pending_;
+#else
+  /**
+   * Derivation stack.
+   */
+  std::vector<StackSymbol> symbolsStack_;
+
+  /**
+   * Last tokens of the items of the right-recursive productions, for their
+   * semantic actions.
+   */
+  std::vector<Token> keptTokens_;
+#endif
+
+  // clang-format off
+  static constexpr size_t NON_TERMINALS_COUNT = {{{NON_TERMINALS_COUNT}}};
+  static constexpr size_t TOKENS_COUNT = {{{TOKENS_COUNT}}};
+
+#if !SYNTAX_PARSER_CODED
+  static constexpr StackSymbol START_SYMBOL = {{{START_SYMBOL}}};
+
+  /**
+   * Derivation stack entry saving the last shifted token, before the tail
+   * of a right-recursive production.
+   */
+  static constexpr StackSymbol KEEP_TOKEN = NON_TERMINALS_COUNT + TOKENS_COUNT;
+
+  /**
+   * LL(1) table: the production number (0 for an error) per non-terminal
+   * and token.
+   */
+  static constexpr ProductionIndex table_[NON_TERMINALS_COUNT * TOKENS_COUNT] = {{{TABLE}}};
+
+  /**
+   * Productions, by the number (1-based), and their reversed RHS symbols.
+   */
+  static constexpr LLProduction productions_[{{{PRODUCTIONS_COUNT}}} + 1] = {{{PRODUCTIONS}}};
+  static constexpr StackSymbol rhs_[{{{RHS_COUNT}}}] = {{{RHS}}};
+#endif
+  // clang-format on
+};
+
+// ------------------------------------------------------------------
+// Productions.
+
+// clang-format off
+{{{PRODUCTION_HANDLERS}}}
+// clang-format on
+
+inline void yyparse::handle_(yyparse& parser, int productionNumber) {
+  switch (productionNumber) {
+    // clang-format off
+    {{{PRODUCTION_ACTIONS}}}
+    // clang-format on
+  }
+}
+{{{CODED_DRIVER}}}
+}  // namespace syntax
+
+#endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+// ------------------------------------------------------------------
+// Direct-coded LR driver (`--driver coded`).
+//
+// The automaton is compiled into code: each state is a case, with a
+// `switch` on the lookahead token, and the gotos after the reductions are
+// a `switch` on the uncovered state. The handlers are called directly, so
+// they can be inlined. The parsing table is still used for the error
+// reporting and the recovery.
+
+/**
+ * Shifts the token, going to the `next` state.
+ */
+#define SHIFT_TO(next) \
+  state = next;        \
+  goto shift
+
+/**
+ * Reduces by the production, and dispatches the state after the goto
+ * (unless the callback of `parseItems` stops parsing).
+ */
+#define REDUCE_BY(production)                                 \
+  tokenizer.yytext = tokenizer.getTokenText(shiftedToken);   \
+  if (!reduce_(production)) {                                 \
+    return stopped_();                                        \
+  }                                                           \
+  goto dispatch
+
+template <typename NextToken>
+ParseResult yyparse::run_(NextToken& nextToken) {
+#if SYNTAX_PARSER_STATS
+  StatsTimer timer{stats_.time};
+#endif
+
+  Token token;
+  if (!nextToken(token) && !onSyntaxError_(token, nextToken)) {
+    return failed_();
+  }
+  auto shiftedToken = token;
+
+  int state;
+
+dispatch:
+  state = statesStack.back();
+
+next:
+  switch (state) {
+    // clang-format off
+    {{{CODED_ACTIONS}}}
+    // clang-format on
+  }
+
+error:
+  if (!onSyntaxError_(token, nextToken)) {
+    return failed_();
+  }
+  goto dispatch;
+
+// The shifted state is dispatched without reloading it, unless a syntax
+// error on the next token is recovered, which changes the stacks.
+shift:
+  shift_(state, token, shiftedToken);
+  if (!nextToken(token)) {
+    if (!onSyntaxError_(token, nextToken)) {
+      return failed_();
+    }
+    goto dispatch;
+  }
+  goto next;
+
+accept:
+  return accept_(token);
+}
+
+#undef SHIFT_TO
+#undef REDUCE_BY
+
+inline bool yyparse::reduce_(int productionNumber) {
+  [[maybe_unused]] auto& parser = *this;
+
+  switch (productionNumber) {
+    // clang-format off
+    {{{CODED_REDUCTIONS}}}
+    // clang-format on
+  }
+
+#if SYNTAX_PARSER_STATS
+  stats_.reductions[productionNumber]++;
+  updateMaxDepths_();
+#endif
+
+  if (productions_[productionNumber].opcode == itemSymbol_) {
+    return yieldItem_(*this);
+  }
+  return true;
+}
+
+inline int yyparse::goto_(int symbol, int state) {
+  switch (symbol) {
+    // clang-format off
+    {{{CODED_GOTOS}}}
+    // clang-format on
+  }
+  assert(false);
+  return -1;
+}
@@ -17,19 +17,82 @@
 #ifndef __Syntax_LR_Parser_h
 #define __Syntax_LR_Parser_h
 
+#ifdef __clang__
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunused-private-field"
+#endif
+
+// ------------------------------------
+// Generator options.
+
+// clang-format off
+{{{GENERATOR_OPTIONS}}}
+// clang-format on
 
 #include <assert.h>
+#include <algorithm>
 #include <array>
+#if SYNTAX_PARSER_STATS
+#include <chrono>
+#endif
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iostream>
-#include <map>
+#include <iterator>
 #include <memory>
+#if SYNTAX_PARSER_ARENA
+#include <memory_resource>
+#endif
+#include <optional>
+#if SYNTAX_PARSER_THREADS
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#endif
+#if !SYNTAX_LEXER_DFA
 #include <regex>
+#endif
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
 #include <vector>
 
+#if SYNTAX_LEXER_SIMD && defined(__AVX2__)
+#define SYNTAX_LEXER_SIMD_AVX2 1
+#include <immintrin.h>
+#elif SYNTAX_LEXER_SIMD && (defined(__SSE2__) || defined(_M_X64))
+#define SYNTAX_LEXER_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif SYNTAX_LEXER_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+#define SYNTAX_LEXER_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // ------------------------------------
 // Module include prologue.
 //
@@ -41,7 +104,7 @@
 //
 // Can also include parsing hooks:
 //
-//   void onParseBegin(const Parser& parser, const std::string& str) {
+//   void onParseBegin(const Parser& parser, std::string_view str) {
 //     ...
 //   }
 //
@@ -61,21 +124,257 @@ namespace syntax {
 {{{TOKENIZER}}}
 // clang-format on
 
-#define POP_V()              \
-  parser.valuesStack.back(); \
+/**
+ * Read-only memory-mapped file (`mmap` on POSIX, a file mapping on
+ * Windows). The contents are accessed as a view over the mapped pages,
+ * without reading the file into a buffer.
+ */
+class MappedFile {
+ public:
+  MappedFile() = default;
+
+  explicit MappedFile(const std::string& path) { map_(path); }
+
+  MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+  MappedFile& operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+      unmap_();
+      data_ = other.data_;
+      size_ = other.size_;
+      other.data_ = nullptr;
+      other.size_ = 0;
+    }
+    return *this;
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() { unmap_(); }
+
+  /**
+   * Contents of the file.
+   */
+  std::string_view view() const { return std::string_view{data_, size_}; }
+
+ private:
+  /**
+   * Throws the `std::system_error` of the failed `operation`, with the
+   * error `code` of the system (`errno`, or `GetLastError()` on Windows).
+   */
+  [[noreturn]] static void throwError_(int code, const std::string& path,
+                                       const char* operation) {
+    throw std::system_error(code, std::system_category(),
+                            "Can't " + std::string{operation} + " " + path);
+  }
+
+#ifdef _WIN32
+
+  void map_(const std::string& path) {
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      throwError_(GetLastError(), path, "open");
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+      auto code = GetLastError();
+      CloseHandle(file);
+      throwError_(code, path, "stat");
+    }
+
+    // Empty files can't be mapped.
+    if (size.QuadPart == 0) {
+      CloseHandle(file);
+      return;
+    }
+
+    auto mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    auto code = GetLastError();
+    CloseHandle(file);
+    if (mapping == nullptr) {
+      throwError_(code, path, "map");
+    }
+
+    auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    code = GetLastError();
+    CloseHandle(mapping);
+    if (data == nullptr) {
+      throwError_(code, path, "map");
+    }
+
+    data_ = static_cast<const char*>(data);
+    size_ = static_cast<size_t>(size.QuadPart);
+  }
+
+  void unmap_() {
+    if (data_ != nullptr) {
+      UnmapViewOfFile(data_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+#else
+
+  void map_(const std::string& path) {
+    auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throwError_(errno, path, "open");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      auto code = errno;
+      close(fd);
+      throwError_(code, path, "stat");
+    }
+
+    // Empty files can't be mapped.
+    if (st.st_size == 0) {
+      close(fd);
+      return;
+    }
+
+    auto data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    auto code = errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+      throwError_(code, path, "map");
+    }
+
+    // The tokenizer reads the file once, front to back.
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(data);
+    size_ = static_cast<size_t>(st.st_size);
+  }
+
+  void unmap_() {
+    if (data_ != nullptr) {
+      munmap(const_cast<char*>(data_), size_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+#endif
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+#if SYNTAX_PARSER_ARENA
+
+/**
+ * Arena for the semantic values and AST nodes produced by the grammar
+ * actions: objects are bump-allocated from a monotonic buffer, and are
+ * released all at once.
+ *
+ *   $$ = parser.arena().make<NumericLiteral>(std::stoi(std::string{$1}));
+ *
+ * Releasing the memory is O(1) in the number of objects; destructors are
+ * still called for the objects which are not trivially destructible.
+ */
+class Arena {
+ public:
+  explicit Arena(size_t initialSize = 64 * 1024) : resource_(initialSize) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  ~Arena() { release(); }
+
+  /**
+   * Constructs an object in the arena.
+   */
+  template <typename T, typename... Args>
+  T* make(Args&&... args) {
+    auto object = new (resource_.allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors_ = new (resource_.allocate(sizeof(Destructor),
+                                             alignof(Destructor)))
+          Destructor{[](void* p) { static_cast<T*>(p)->~T(); }, object,
+                     destructors_};
+    }
+
+    return object;
+  }
+
+  /**
+   * Memory resource of the arena, e.g. for `std::pmr` containers.
+   */
+  std::pmr::memory_resource* resource() { return &resource_; }
+
+  /**
+   * Destroys all objects, and releases the memory.
+   */
+  void release() {
+    for (auto d = destructors_; d != nullptr; d = d->next) {
+      d->destroy(d->object);
+    }
+    destructors_ = nullptr;
+    resource_.release();
+  }
+
+ private:
+  /**
+   * Destructor of an object, the list is in the reverse order of creation.
+   */
+  struct Destructor {
+    void (*destroy)(void*);
+    void* object;
+    Destructor* next;
+  };
+
+  std::pmr::monotonic_buffer_resource resource_;
+  Destructor* destructors_ = nullptr;
+};
+
+#endif
+
+#define POP_V()                         \
+  std::move(parser.valuesStack.back()); \
   parser.valuesStack.pop_back()
 
-#define POP_T()              \
-  parser.tokensStack.back(); \
+#define POP_T()                         \
+  std::move(parser.tokensStack.back()); \
   parser.tokensStack.pop_back()
 
-#define PUSH_VR() parser.valuesStack.push_back(__)
-#define PUSH_TR() parser.tokensStack.push_back(__)
+#define PUSH_VR() parser.valuesStack.emplace_back(std::move(__))
+#define PUSH_TR() parser.tokensStack.emplace_back(std::move(__))
+
+// The result of a production without a semantic action: the default
+// `Value`, which then has to be default-constructible.
+
+#define PUSH_DEFAULT_V()                                          \
+  static_assert(std::is_default_constructible_v<Value>,           \
+                "A production without a semantic action needs a " \
+                "default-constructible Value");                   \
+  parser.valuesStack.emplace_back()
+
+// In-place handler arguments (`--handler-args inplace`): the n-th entry
+// from the top of a stack, and the truncation of a stack after the action.
+
+#define STACK_V(n) parser.valuesStack[parser.valuesStack.size() - (n)]
+#define STACK_T(n) parser.tokensStack[parser.tokensStack.size() - (n)]
+
+#define DROP_V(n)                                             \
+  parser.valuesStack.erase(parser.valuesStack.end() - (n), \
+                           parser.valuesStack.end())
+#define DROP_T(n) parser.tokensStack.resize(parser.tokensStack.size() - (n))
 
 /**
- * Parsing table type.
+ * Parsing table type. Zero-initialized entries are errors.
  */
 enum class TE {
+  Error,
   Accept,
   Shift,
   Reduce,
@@ -83,11 +382,42 @@ enum class TE {
 };
 
 /**
- * Parsing table entry.
+ * Integer types of the parsing states, the packed table entries, and the
+ * productions: the narrowest ones for the grammar (`SYNTAX_PARSER_COMPACT`),
+ * so that the table and the states stack take fewer cache lines, or the
+ * 32-bit ones.
+ */
+#if SYNTAX_PARSER_COMPACT
+// clang-format off
+using StateIndex = {{{STATE_TYPE}}};
+using TableWord = {{{TABLE_WORD_TYPE}}};
+using SymbolIndex = {{{SYMBOL_TYPE}}};
+using RHSLength = {{{RHS_LENGTH_TYPE}}};
+// clang-format on
+#else
+using StateIndex = int32_t;
+using TableWord = uint32_t;
+using SymbolIndex = int32_t;
+using RHSLength = int32_t;
+#endif
+
+/**
+ * Parsing table entry, packed into a word: the type in the low bits, and
+ * the state or the production number in the high bits.
  */
 struct TableEntry {
-  TE type;
-  int value;
+  static constexpr int TYPE_BITS = 3;
+  static constexpr TableWord TYPE_MASK = (1 << TYPE_BITS) - 1;
+
+  constexpr TableEntry() = default;
+  constexpr TableEntry(TE type, int value)
+      : word(static_cast<TableWord>((value << TYPE_BITS) |
+                                    static_cast<int>(type))) {}
+
+  constexpr TE type() const { return static_cast<TE>(word & TYPE_MASK); }
+  constexpr int value() const { return word >> TYPE_BITS; }
+
+  TableWord word = 0;
 };
 
 // clang-format off
@@ -96,193 +426,1720 @@ class {{{PARSER_CLASS_NAME}}};
 
 using yyparse = {{{PARSER_CLASS_NAME}}};
 
-typedef void (*ProductionHandler)(yyparse&);
-
 /**
- * Encoded production.
+ * Encoded production, its semantic action is dispatched by the number
+ * (`yyparse::handle_`).
  *
  * opcode - encoded index
  * rhsLength - length of the RHS to pop.
  */
 struct Production {
-  int opcode;
-  int rhsLength;
-  ProductionHandler handler;
+  SymbolIndex opcode;
+  RHSLength rhsLength;
 };
 
-// Key: Encoded symbol (terminal or non-terminal) index
-// Value: TableEntry
-using Row = std::map<int, TableEntry>;
-
 /**
- * Parser class.
+ * Non-terminals with the values, by their encoded symbol (see
+ * `yyparse::parseItems`).
  */
-// clang-format off
-class {{{PARSER_CLASS_NAME}}} {
+enum class NonTerminal {
+  // clang-format off
+  {{{NON_TERMINALS}}}
   // clang-format on
- public:
-  /**
-   * Parsing values stack.
-   */
-  std::vector<Value> valuesStack;
+};
 
-  /**
-   * Token values stack.
-   */
-  std::vector<std::string> tokensStack;
+/**
+ * Result of `tryParse`: the value, or the (first) syntax error record.
+ * With the error recovery, the recovered parse has both.
+ */
+struct ParseResult {
+  std::optional<Value> value;
+  SyntaxError error;
 
-  /**
-   * Parsing states stack.
-   */
-  std::vector<int> statesStack;
+  bool ok() const { return error.kind == SyntaxErrorKind::None; }
+};
 
-  /**
-   * Tokenizer.
-   */
-  Tokenizer tokenizer;
+/**
+ * Status of the push parsing after the fed input.
+ */
+enum class PushStatus : uint8_t {
+  NeedInput,  // The input is consumed, more is expected (or `finish`).
+  Failed,     // A syntax error, see `syntaxErrors`; the parse is over.
+};
 
-  /**
-   * Previous state to calculate the next one.
-   */
-  int previousState;
+#if SYNTAX_PARSER_STATS
+/**
+ * Parser statistics (`SYNTAX_PARSER_STATS`), accumulated over the parses
+ * until `resetStats`. The reductions are indexed by the production, see
+ * `productionName`.
+ */
+struct ParserStats {
+  TokenizerStats tokenizer;
 
-  /**
-   * Parses a string.
-   */
-  Value parse(const std::string& str) {
-    // clang-format off
-    {{{ON_PARSE_BEGIN_CALL}}}
-    // clang-format on
+  uint64_t shifts = 0;
+  std::vector<uint64_t> reductions;
 
-    // Initialize the tokenizer and the string.
-    tokenizer.initString(str);
+  // Maximum depths of the stacks.
+  size_t maxStatesDepth = 0;
+  size_t maxValuesDepth = 0;
+  size_t maxTokensDepth = 0;
 
-    // Initialize the stacks.
-    valuesStack.clear();
-    tokensStack.clear();
-    statesStack.clear();
+  // Time spent parsing, the tokenizer included.
+  std::chrono::nanoseconds time{0};
 
-    // Initial 0 state.
-    statesStack.push_back(0);
+  // Time spent in the parser itself.
+  std::chrono::nanoseconds parserTime() const { return time - tokenizer.time; }
+};
+#endif
 
-    auto token = tokenizer.getNextToken();
-    auto shiftedToken = token;
+#if SYNTAX_PARSER_REPARSE
+/**
+ * Edit of the editable text: the `removedLength` bytes at the `offset` are
+ * replaced with the `insertedText`.
+ */
+struct Edit {
+  size_t offset;
+  size_t removedLength;
+  std::string_view insertedText;
+};
 
-    // Main parsing loop.
-    for (;;) {
-      auto state = statesStack.back();
-      auto column = (int)token->type;
+/**
+ * Token on the tokens stack of a checkpoint: an offset in the text (with
+ * the null `data`), or a view outside of the text.
+ */
+struct CheckpointToken {
+  const char* data;
+  size_t offset;
+  size_t length;
+};
 
-      if (table_[state].count(column) == 0) {
-        throwUnexpectedToken(token);
-      }
+/**
+ * State of the parsing stacks before reading a token.
+ */
+struct Checkpoint {
+  size_t tokenIndex;
+  std::vector<StateIndex> states;
+  std::vector<Value> values;
+  std::vector<CheckpointToken> tokens;
+  size_t errors;
+  int recovering;
+};
+#endif
 
-      auto entry = table_[state].at(column);
+#if SYNTAX_PARSER_THREADS
+/**
+ * Result of parsing one input of a batch, as of `tryParse`: the value,
+ * unless the input failed to parse, and the syntax errors, with the message
+ * of the first one (or of the exception which failed the parse). An input
+ * recovered from its errors has both the value and the errors.
+ */
+struct BatchResult {
+  std::optional<Value> value;
+  std::vector<SyntaxError> errors;
+  std::string error;
 
-      // Shift a token, go to state.
-      if (entry.type == TE::Shift) {
-        // Push token.
-        tokensStack.push_back(token->value);
+  bool ok() const { return value.has_value() && error.empty(); }
+};
 
-        // Push next state number: "s5" -> 5
-        statesStack.push_back(entry.value);
+/**
+ * Called with the index of an input in the batch, and its result.
+ */
+using BatchCallback = std::function<void(size_t index, BatchResult&& result)>;
 
-        shiftedToken = token;
-        token = tokenizer.getNextToken();
-      }
+/**
+ * Range of the batch indices of a worker. The worker takes the inputs from
+ * the front, and the idle workers steal the back half.
+ */
+struct alignas(64) BatchRange {
+  std::mutex mutex;
+  size_t begin = 0;
+  size_t end = 0;
 
-      // Reduce by production.
-      else if (entry.type == TE::Reduce) {
-        auto productionNumber = entry.value;
-        auto production = productions_[productionNumber];
+  bool pop(size_t& index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (begin == end) {
+      return false;
+    }
+    index = begin++;
+    return true;
+  }
 
-        tokenizer.yytext = shiftedToken->value;
+  /**
+   * Steals the back half of the victim's range into this (empty) range.
+   */
+  bool stealFrom(BatchRange& victim) {
+    std::scoped_lock lock(mutex, victim.mutex);
+    auto size = victim.end - victim.begin;
+    if (size == 0) {
+      return false;
+    }
+    end = victim.end;
+    begin = end - (size + 1) / 2;
+    victim.end = begin;
+    return true;
+  }
+};
 
-        auto rhsLength = production.rhsLength;
-        while (rhsLength > 0) {
-          statesStack.pop_back();
-          rhsLength--;
-        }
+/**
+ * Threads of the parallel parses (`parseBatch`, `parseParallel`), started
+ * on the first use, and reused by the next calls, so the small and
+ * frequent batches don't start threads each time. The calling thread is
+ * the first worker.
+ */
+class WorkerPool {
+ public:
+  explicit WorkerPool(size_t size) {
+    threads_.reserve(size - 1);
+    for (size_t w = 1; w < size; w++) {
+      threads_.emplace_back([this, w] { loop_(w); });
+    }
+  }
 
-        // Call the handler.
-        production.handler(*this);
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
 
-        auto previousState = statesStack.back();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
 
-        auto symbolToReduceWith = production.opcode;
-        auto nextStateEntry = table_[previousState].at(symbolToReduceWith);
-        assert(nextStateEntry.type == TE::Transit);
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
 
-        statesStack.push_back(nextStateEntry.value);
-      }
+  /**
+   * Number of the workers, with the calling thread.
+   */
+  size_t size() const { return threads_.size() + 1; }
 
-      // Accept the string.
-      else if (entry.type == TE::Accept) {
-        // Pop state number.
-        statesStack.pop_back();
-
-        // Pop the parsed value.
-        // clang-format off
-        {{{PARSED_RESULT}}}
-        // clang-format on
-
-        if (statesStack.size() != 1 || statesStack.back() != 0 ||
-            tokenizer.hasMoreTokens()) {
-          throwUnexpectedToken(token);
-        }
+  /**
+   * Runs the `work(index)` in `count` (at most `size()`) workers, and waits
+   * for all of them.
+   */
+  void run(size_t count, const std::function<void(size_t)>& work) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      work_ = &work;
+      count_ = count;
+      running_ = count - 1;
+      generation_++;
+    }
+    wake_.notify_all();
 
-        statesStack.pop_back();
+    // The other workers use the `work` until they are done.
+    std::exception_ptr error;
+    try {
+      work(0);
+    } catch (...) {
+      error = std::current_exception();
+    }
 
-        // clang-format off
-        {{{ON_PARSE_END_CALL}}}
-        // clang-format on
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return running_ == 0; });
 
-        return result;
-      }
+    if (error) {
+      std::rethrow_exception(error);
     }
   }
 
  private:
-  /**
-   * Throws parser error on unexpected token.
-   */
-  [[noreturn]] void throwUnexpectedToken(SharedToken token) {
-    if (token->type == TokenType::__EOF && !tokenizer.hasMoreTokens()) {
-      std::string errMsg = "Unexpected end of input.\n";
-      std::cerr << errMsg;
-      throw std::runtime_error(errMsg.c_str());
+  void loop_(size_t w) {
+    uint64_t generation = 0;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      wake_.wait(lock,
+                 [&] { return stopping_ || generation_ != generation; });
+      if (stopping_) {
+        return;
+      }
+      generation = generation_;
+      if (w >= count_) {
+        continue;
+      }
+
+      auto work = work_;
+      lock.unlock();
+      (*work)(w);
+      lock.lock();
+
+      if (--running_ == 0) {
+        done_.notify_one();
+      }
     }
-    tokenizer.throwUnexpectedToken(token->value, token->startLine,
-                                   token->startColumn);
   }
 
-  // clang-format off
-  static constexpr size_t PRODUCTIONS_COUNT = {{{PRODUCTIONS_COUNT}}};
-  static std::array<Production, PRODUCTIONS_COUNT> productions_;
+  std::vector<std::thread> threads_;
 
-  static constexpr size_t ROWS_COUNT = {{{ROWS_COUNT}}};
-  static std::array<Row, ROWS_COUNT> table_;
-  // clang-format on
-};
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
 
-// ------------------------------------------------------------------
-// Productions.
+  const std::function<void(size_t)>* work_ = nullptr;
+  size_t count_ = 0;
+  size_t running_ = 0;
+  uint64_t generation_ = 0;
+  bool stopping_ = false;
+};
+#endif
 
+/**
+ * Parser class.
+ *
+ * Thread safety: the parsing and lexing tables are immutable, constant
+ * initialized data shared by all instances, so parsers can run concurrently
+ * in different threads. An instance itself is not synchronized: use one
+ * parser per thread.
+ */
 // clang-format off
-{{{PRODUCTION_HANDLERS}}}
-// clang-format on
+class {{{PARSER_CLASS_NAME}}} {
+  // clang-format on
+ public:
+  /**
+   * Parser instances are reusable: each parse resets the state, keeping
+   * the capacity of the stacks and of the tokenizer buffers, so in the
+   * steady state parsing doesn't allocate (besides what the semantic
+   * actions allocate for the values).
+   *
+   * The stacks are pre-sized to the `SYNTAX_PARSER_STACK_RESERVE` depth.
+   */
+  // clang-format off
+  {{{PARSER_CLASS_NAME}}}() {
+    // clang-format on
+    reserve(SYNTAX_PARSER_STACK_RESERVE);
+  }
 
-// clang-format off
-std::array<Production, yyparse::PRODUCTIONS_COUNT> yyparse::productions_ = {{{PRODUCTIONS}}};
-// clang-format on
+  /**
+   * Resets the parsing state, keeping the allocated capacity. Called at
+   * the beginning of each parse; can be called to drop the values of the
+   * previous parse earlier.
+   */
+  void reset() {
+    valuesStack.clear();
+    tokensStack.clear();
+    statesStack.clear();
+  }
 
-// ------------------------------------------------------------------
-// Parsing table.
+  /**
+   * Reserves the stacks for the parsing depth.
+   */
+  void reserve(size_t depth) {
+    valuesStack.reserve(depth);
+    tokensStack.reserve(depth);
+    statesStack.reserve(depth + 1);
+  }
 
-// clang-format off
-std::array<Row, yyparse::ROWS_COUNT> yyparse::table_ = {{{TABLE}}};
-// clang-format on
+  /**
+   * Parsing values stack.
+   */
+  std::vector<Value> valuesStack;
 
+  /**
+   * Token values stack: views into the parsing string.
+   */
+  std::vector<std::string_view> tokensStack;
+
+  /**
+   * Parsing states stack.
+   */
+  std::vector<StateIndex> statesStack;
+
+  /**
+   * Tokenizer.
+   */
+  Tokenizer tokenizer;
+
+  /**
+   * Previous state to calculate the next one.
+   */
+  int previousState;
+
+#if SYNTAX_PARSER_ARENA
+  /**
+   * Arena for the values created by the semantic actions. The objects
+   * live until the arena is released (`arena().release()`), or, if the
+   * arena is taken by `takeArena()`, until the taken arena is dropped.
+   */
+  Arena& arena() {
+    if (!arena_) {
+      arena_ = std::make_unique<Arena>();
+    }
+    return *arena_;
+  }
+
+  /**
+   * Takes the ownership of the current arena, e.g. to keep it with the
+   * parsed result; the next parse starts a new one.
+   */
+  std::unique_ptr<Arena> takeArena() { return std::move(arena_); }
+#endif
+
+  /**
+   * Parses a string. The string is not copied, and should outlive
+   * the parsing.
+   *
+   * Throws `SyntaxErrorException` on syntax errors.
+   */
+  Value parse(std::string_view str) {
+    // Initialize the tokenizer and the string.
+    tokenizer.initString(str);
+
+    return valueOrThrow_(parse_(str));
+  }
+
+  /**
+   * Parses a string, returning the syntax error instead of throwing it (the
+   * exceptions of the semantic actions are still propagated). Nothing is
+   * written to the `stderr`: the message is formatted on demand, by the
+   * `formatError`.
+   */
+  ParseResult tryParse(std::string_view str) {
+    tokenizer.initString(str);
+
+    return parse_(str);
+  }
+
+  /**
+   * Called with each item of `parseItems`, returns false to stop parsing.
+   */
+  using ItemCallback = std::function<bool(Value&& item)>;
+
+  /**
+   * Parses a string, passing the values of the `item` non-terminal at the
+   * top level to the `callback` as they are reduced, instead of building
+   * the whole result: e.g. the statements of a program, or the records of
+   * a log. The callback can stop parsing early, in which case false is
+   * returned. Throws `SyntaxErrorException` on syntax errors.
+   *
+   * An item is at the top level if only the non-terminals are below it on
+   * the stack, i.e. it's not enclosed by a token (as a statement in a
+   * block). So the item should not begin a larger one, as `E` does in
+   * `E : E '+' E`. The items are moved out: the enclosing productions get
+   * the default `Value`s for them, so (if `parseItems` is used) the
+   * `Value` should be default-constructible and move-assignable.
+   */
+  template <typename ItemValue = Value>
+  bool parseItems(std::string_view str, NonTerminal item,
+                  const ItemCallback& callback) {
+    tokenizer.initString(str);
+
+    itemSymbol_ = (int)item;
+    itemCallback_ = &callback;
+    yieldItem_ = &yyparse::yieldItemValue_<ItemValue>;
+    itemsStopped_ = false;
+
+    ParseResult parsed;
+    try {
+      parsed = parse_(str);
+    } catch (...) {
+      itemSymbol_ = -1;
+      throw;
+    }
+
+    itemSymbol_ = -1;
+    if (itemsStopped_) {
+      return false;
+    }
+    valueOrThrow_(std::move(parsed));
+    return true;
+  }
+
+  /**
+   * Tokens expected in the state of a syntax error.
+   */
+  std::vector<TokenType> expectedTokens(const SyntaxError& error) const {
+    std::vector<TokenType> tokens;
+    if (error.state < 0) {
+      return tokens;
+    }
+
+    // Non-terminals have only the transitions.
+    auto row = &table_[error.state * SYMBOLS_COUNT];
+    for (size_t column = 0; column < SYMBOLS_COUNT; column++) {
+      if (row[column].type() != TE::Error && row[column].type() != TE::Transit) {
+        tokens.push_back((TokenType)column);
+      }
+    }
+#if SYNTAX_PARSER_RECOVERY
+    tokens.erase(std::remove(tokens.begin(), tokens.end(), TokenType::error),
+                 tokens.end());
+#endif
+    return tokens;
+  }
+
+  /**
+   * Syntax errors of the last parse, in the input order. Without the error
+   * recovery, there is at most one.
+   */
+  const std::vector<SyntaxError>& syntaxErrors() const { return errors_; }
+
+  /**
+   * Size of the static parsing and lexing tables, in bytes.
+   */
+  static constexpr size_t tablesSize() {
+    return sizeof(table_) + sizeof(productions_) +
+#if SYNTAX_PARSER_RECOVERY
+           sizeof(stateTokens_) +
+#endif
+           sizeof(stateTerminals_) +
+           Tokenizer::tablesSize();
+  }
+
+  /**
+   * Message of a syntax error of the last parse, showing the source line.
+   */
+  std::string formatError(const SyntaxError& error) const {
+    return tokenizer.formatError(error);
+  }
+
+#if SYNTAX_PARSER_STATS
+  /**
+   * Statistics of the parses of this parser (the workers of `parseBatch`
+   * and `parseParallel` keep their own), and of its tokenizer.
+   */
+  ParserStats stats() const {
+    auto stats = stats_;
+    stats.tokenizer = tokenizer.stats();
+    return stats;
+  }
+
+  void resetStats() {
+    stats_ = emptyStats_();
+    tokenizer.resetStats();
+  }
+
+  /**
+   * Production in the `LHS -> RHS` form, for the per-production statistics.
+   */
+  static std::string_view productionName(size_t index) {
+    return productionNames_[index];
+  }
+#endif
+
+  /**
+   * Parses a file, tokenizing directly over its memory-mapped pages.
+   *
+   * The mapping is kept until the next `parseFile` call (or the parser
+   * destruction), so token views kept in the values stay valid until then.
+   */
+  Value parseFile(const std::string& path) {
+    mappedFile_ = std::make_shared<MappedFile>(path);
+
+    auto str = mappedFile_->view();
+    tokenizer.initString(str);
+
+    return valueOrThrow_(parse_(str));
+  }
+
+  /**
+   * Parses an input stream incrementally, reading it in chunks, without
+   * keeping the whole input in memory (see `Tokenizer::initStream`).
+   *
+   * Token values (`$1`, etc) are views into the sliding window, which are
+   * valid during the semantic action only, so values should own the
+   * strings they keep.
+   */
+  Value parseStream(std::istream& stream,
+                    size_t chunkSize = Tokenizer::DEFAULT_CHUNK_SIZE) {
+    tokenizer.initStream(stream, chunkSize);
+    tokenizer.retainViews(&tokensStack);
+
+    return valueOrThrow_(parse_(std::string_view{}));
+  }
+
+  /**
+   * Parses an input source, which is called to read the next chunk.
+   */
+  Value parseStream(Tokenizer::InputSource source,
+                    size_t chunkSize = Tokenizer::DEFAULT_CHUNK_SIZE) {
+    tokenizer.initStream(std::move(source), chunkSize);
+    tokenizer.retainViews(&tokensStack);
+
+    return valueOrThrow_(parse_(std::string_view{}));
+  }
+
+  /**
+   * Begins parsing of the pushed input: the data is fed as it arrives
+   * (e.g. from a socket), and the parse proceeds as far as the fed data
+   * allows, without blocking for the rest. The parsing state is kept in
+   * the parser between the calls, so one thread can drive many parses,
+   * with a parser instance per parse.
+   *
+   * As when streaming, token values (`$1`, etc) are valid during the
+   * semantic action only. The table driver is used for pushing.
+   */
+  void beginPush() {
+    tokenizer.initPush();
+    tokenizer.retainViews(&tokensStack);
+
+    begin_(std::string_view{});
+
+    pushRead_ = true;
+    pushDone_ = false;
+    pushResult_ = ParseResult{};
+  }
+
+  /**
+   * Feeds the next part of the pushed input, which is copied, parsing the
+   * tokens it completes.
+   */
+  PushStatus feed(std::string_view data) {
+    if (!pushDone_) {
+      tokenizer.feed(data);
+      pushDone_ = push_();
+    }
+    return pushDone_ ? PushStatus::Failed : PushStatus::NeedInput;
+  }
+
+  /**
+   * Ends the pushed input, finishing the parse (see `tryParse`).
+   */
+  ParseResult finish() {
+    if (!pushDone_) {
+      tokenizer.finishInput();
+      pushDone_ = push_();
+      assert(pushDone_);
+    }
+    return std::move(pushResult_);
+  }
+
+#if SYNTAX_PARSER_REPARSE
+  /**
+   * Parses a text, which can then be edited, and reparsed with `reparse`.
+   * The parser keeps a copy of the text, the tokens (with the tokenizer
+   * states before each of them), and checkpoints of the parsing stacks
+   * every `REPARSE_CHECKPOINT` tokens. Each checkpoint copies the whole
+   * stacks (the values too), so a deep stack makes the checkpoints of the
+   * parse, and of each reparse after it, costlier.
+   *
+   * The text is modified by the edits, so values should own the strings
+   * they keep (as when streaming). Without a copyable `Value` there are no
+   * checkpoints, and each reparse parses from the beginning (relexing
+   * still only the edit).
+   */
+  Value parseEditable(std::string_view text) {
+    return valueOrThrow_(tryParseEditable(text));
+  }
+
+  /**
+   * Non-throwing `parseEditable`, see `tryParse`.
+   */
+  ParseResult tryParseEditable(std::string_view text) {
+    editedText_.clear();
+    editedTokens_.clear();
+    editedStates_.clear();
+    lexStatesPool_.clear();
+    checkpoints_.clear();
+
+    return tryReparse(Edit{0, 0, text});
+  }
+
+  /**
+   * Applies the edit to the text, and reparses it: only the lexing is
+   * incremental. Tokenizing resumes at the token before the edit (the
+   * tokenizer can look ahead of a token), and stops once a token after the
+   * edit starts at the same place, in the same tokenizer states, as before
+   * the edit: the following tokens are reused, with their offsets shifted.
+   * Parsing restarts from the last checkpoint before the edit (the
+   * `onParseBegin` hook is not called then), and runs to the end of the
+   * text: the values of the handlers are opaque, so the old stacks after
+   * the edit can't be reused. A reparse costs the tokens from that
+   * checkpoint to the end, not the size of the edit: its latency grows with
+   * the distance of the edit from the end of the text, up to about a full
+   * parse (without the lexing) for an edit at the start.
+   *
+   * The `insertedText` should not be a view into the parsed text.
+   */
+  Value reparse(const Edit& edit) { return valueOrThrow_(tryReparse(edit)); }
+
+  /**
+   * Non-throwing `reparse`, see `tryParse`.
+   */
+  ParseResult tryReparse(const Edit& edit) {
+    auto& text = editedText_;
+    auto& tokens = editedTokens_;
+    auto& states = editedStates_;
+
+    auto offset = std::min(edit.offset, text.size());
+    auto removed = std::min(edit.removedLength, text.size() - offset);
+    auto inserted = edit.insertedText.size();
+    text.replace(offset, removed, edit.insertedText);
+
+    auto editEnd = offset + inserted;
+
+    // The token before the first one ending at the edit (or after it).
+    size_t first = std::lower_bound(tokens.begin(), tokens.end(), offset,
+                                    [](const Token& token, size_t offset) {
+                                      return token.endOffset() < offset;
+                                    }) -
+                   tokens.begin();
+    if (first > 0) {
+      first--;
+    }
+
+    auto begin = first > 0 ? tokens[first - 1].endOffset() : 0;
+
+    tokenizer.initRange(text, begin, text.size());
+    if (first < tokens.size()) {
+      tokenizer.restoreStates(lexStatesPool_[states[first]]);
+    }
+
+    // Relex until the old tokens are reached, after the edit.
+    relexedTokens_.clear();
+    relexedStates_.clear();
+
+    auto reused = first;
+    for (;;) {
+      auto at = tokenizer.getCursorOffset();
+
+      if (at >= editEnd) {
+        // The position before the edit.
+        auto oldAt = at - inserted + removed;
+        while (reused < tokens.size() && lexStart_(reused) < oldAt) {
+          reused++;
+        }
+        // The EOF has the location of the last matched text, which may be
+        // a skipped one, so it's relexed.
+        if (reused + 1 < tokens.size() && lexStart_(reused) == oldAt &&
+            tokenizer.getStates() == lexStatesPool_[states[reused]]) {
+          break;
+        }
+      }
+
+      auto lexStates = internLexStates_();
+
+      Token token;
+      tokenizer.tryGetNextToken(token);
+
+      relexedTokens_.push_back(token);
+      relexedStates_.push_back(lexStates);
+
+      if (token.type == TokenType::__EOF) {
+        reused = tokens.size();
+        break;
+      }
+    }
+
+    tokens.erase(tokens.begin() + first, tokens.begin() + reused);
+    tokens.insert(tokens.begin() + first, relexedTokens_.begin(),
+                  relexedTokens_.end());
+
+    states.erase(states.begin() + first, states.begin() + reused);
+    states.insert(states.begin() + first, relexedStates_.begin(),
+                  relexedStates_.end());
+
+    // The shift is linear in the following tokens, as is the parse after
+    // the checkpoint, which reads them all anyway.
+    for (auto i = first + relexedTokens_.size(); i < tokens.size(); i++) {
+      auto& token = tokens[i];
+      token.startOffset = token.startOffset - removed + inserted;
+    }
+
+    // Checkpoints up to the first relexed token are still valid.
+    while (!checkpoints_.empty() && checkpoints_.back().tokenIndex > first) {
+      checkpoints_.pop_back();
+    }
+
+    return reparse_();
+  }
+
+  /**
+   * Text of the editable parsing, with the edits applied.
+   */
+  const std::string& editedText() const { return editedText_; }
+
+  /**
+   * Number of tokens between the checkpoints of the editable parsing.
+   */
+  static constexpr size_t REPARSE_CHECKPOINT = 1024;
+#endif
+
+#if SYNTAX_PARSER_THREADS
+  /**
+   * Parses independent inputs in parallel, returning the results in the
+   * order of the inputs. A failed input records its error, and doesn't
+   * abort the batch.
+   *
+   * The `threads` defaults to the hardware concurrency. This parser is one
+   * of the workers, others use their own parser instance, reused for all
+   * inputs they take. The threads and the parsers of the workers are kept
+   * by this parser for the next calls (see `WorkerPool`), and are released
+   * with it. With the arena, the arenas of the workers are kept until the
+   * next `parseBatch` call (or the parser destruction).
+   */
+  std::vector<BatchResult> parseBatch(
+      const std::vector<std::string_view>& inputs, size_t threads = 0) {
+    std::vector<BatchResult> results(inputs.size());
+
+    parseBatch(inputs.data(), inputs.size(),
+               [&results](size_t index, BatchResult&& result) {
+                 results[index] = std::move(result);
+               },
+               threads);
+
+    return results;
+  }
+
+  /**
+   * Parses independent inputs in parallel, calling the `callback` with
+   * each result as soon as it's ready. The callback is called from the
+   * worker threads, in no particular order, and should not throw.
+   */
+  void parseBatch(const std::string_view* inputs, size_t count,
+                  const BatchCallback& callback, size_t threads = 0) {
+    if (threads == 0) {
+      threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threads = std::min(threads, count);
+
+    if (threads <= 1) {
+      for (size_t i = 0; i < count; i++) {
+        callback(i, parseBatchInput_(*this, inputs[i]));
+      }
+      return;
+    }
+
+    // Initially each worker owns an equal slice of the inputs.
+    std::vector<BatchRange> ranges(threads);
+    for (size_t w = 0; w < threads; w++) {
+      ranges[w].begin = count * w / threads;
+      ranges[w].end = count * (w + 1) / threads;
+    }
+
+    auto work = [&](yyparse& parser, size_t w) {
+      for (;;) {
+        size_t index;
+        while (ranges[w].pop(index)) {
+          callback(index, parseBatchInput_(parser, inputs[index]));
+        }
+
+        auto stolen = false;
+        for (size_t i = 1; i < threads && !stolen; i++) {
+          stolen = ranges[w].stealFrom(ranges[(w + i) % threads]);
+        }
+
+        if (!stolen) {
+          return;
+        }
+      }
+    };
+
+    // The parsers of the other workers, created on the first use.
+    if (batchParsers_.size() < threads) {
+      batchParsers_.resize(threads);
+    }
+    for (size_t w = 1; w < threads; w++) {
+      if (!batchParsers_[w]) {
+        batchParsers_[w] = std::make_unique<yyparse>();
+      }
+    }
+
+#if SYNTAX_PARSER_ARENA
+    batchArenas_.clear();
+#endif
+
+    runWorkers_(threads, [&](size_t w) {
+      work(w == 0 ? *this : *batchParsers_[w], w);
+    });
+
+#if SYNTAX_PARSER_ARENA
+    for (size_t w = 1; w < threads; w++) {
+      if (auto arena = batchParsers_[w]->takeArena()) {
+        batchArenas_.push_back(std::move(arena));
+      }
+    }
+#endif
+  }
+
+  /**
+   * Parses a large string, tokenizing its chunks in parallel, and then
+   * running a single parsing pass over the stitched tokens.
+   *
+   * The string is split after the occurrences of the `separator` (e.g. a
+   * newline, or ";\n"), which should only occur where a token ends, and
+   * where the tokenizer is in the INITIAL state. The offsets of the tokens,
+   * and the errors (the first of which, in the order of the input, is
+   * thrown), are the same as when parsing the whole string.
+   *
+   * The `threads` defaults to the hardware concurrency (at most one per
+   * `PARALLEL_MIN_CHUNK` bytes).
+   */
+  Value parseParallel(std::string_view str, std::string_view separator,
+                      size_t threads = 0) {
+    if (threads == 0) {
+      threads = std::max(std::thread::hardware_concurrency(), 1u);
+      threads = std::min(threads, str.size() / PARALLEL_MIN_CHUNK + 1);
+    }
+
+    // Chunk boundaries, after a separator next to an equal split.
+    std::vector<size_t> bounds{0};
+    for (size_t i = 1; i < threads && !separator.empty(); i++) {
+      auto split = std::max(str.size() * i / threads, bounds.back());
+      auto found = str.find(separator, split);
+      if (found == str.npos) {
+        break;
+      }
+      bounds.push_back(found + separator.size());
+    }
+    bounds.push_back(str.size());
+
+    auto chunksCount = bounds.size() - 1;
+
+    if (chunksCount == 1) {
+      return parse(str);
+    }
+
+    chunkTokens_.resize(chunksCount);
+
+    // The EOF of each chunk, located at its last match, and the exception
+    // which stopped it.
+    std::vector<Token> eofs(chunksCount);
+    std::vector<std::exception_ptr> errors(chunksCount);
+
+    // Tokenize the chunks, with the offsets in the whole string. The
+    // unexpected input is kept in the tokens, as the `__EMPTY` one, so the
+    // parsing pass reports the errors in the order of the input.
+    runWorkers_(chunksCount, [&](size_t c) {
+      auto& tokens = chunkTokens_[c];
+      tokens.clear();
+
+      Tokenizer chunkTokenizer;
+      chunkTokenizer.initRange(str, bounds[c], bounds[c + 1]);
+
+      try {
+        for (;;) {
+          Token token;
+          chunkTokenizer.tryGetNextToken(token);
+          if (token.type == TokenType::__EOF) {
+            eofs[c] = token;
+            break;
+          }
+          tokens.push_back(token);
+        }
+      } catch (...) {
+        errors[c] = std::current_exception();
+      }
+    });
+
+    // The EOF is at the last match of the string, as when tokenizing it
+    // whole: the one of the last chunk (unless it's empty, after the
+    // separator at the end).
+    auto last = bounds[chunksCount - 1] < str.size() ? chunksCount - 1
+                                                     : chunksCount - 2;
+    auto eof = eofs[last];
+
+    // The tokenizer is past the end of the string, as after a full parse.
+    tokenizer.initRange(str, str.size(), str.size());
+    Token end;
+    tokenizer.tryGetNextToken(end);
+
+    size_t chunk = 0;
+    size_t index = 0;
+
+    return valueOrThrow_(parse_(str, [&](Token& token) {
+      while (chunk < chunksCount) {
+        if (index < chunkTokens_[chunk].size()) {
+          token = chunkTokens_[chunk][index++];
+          return token.type != TokenType::__EMPTY;
+        }
+        // A lex handler failed after the last token of the chunk.
+        if (errors[chunk]) {
+          std::rethrow_exception(errors[chunk]);
+        }
+        chunk++;
+        index = 0;
+      }
+      token = eof;
+      return true;
+    }));
+  }
+
+  /**
+   * Minimal size of a chunk per thread in `parseParallel`.
+   */
+  static constexpr size_t PARALLEL_MIN_CHUNK = 256 * 1024;
+#endif
+
+ private:
+#if SYNTAX_PARSER_REPARSE
+  /**
+   * Parses the tokens of the editable parsing, from the last checkpoint to
+   * the end, adding the checkpoints of the following tokens.
+   */
+  ParseResult reparse_() {
+    const auto& tokens = editedTokens_;
+    const auto& text = editedText_;
+
+    // The tokenizer is past the end of the text, as after a full parse (for
+    // the error reporting), the last token is the EOF, repeated if read again.
+    tokenizer.initRange(text, text.size(), text.size());
+    Token eof;
+    tokenizer.tryGetNextToken(eof);
+
+    size_t index = 0;
+
+    auto nextToken = [&](Token& token) {
+      if (index % REPARSE_CHECKPOINT == 0 && index > 0 &&
+          (checkpoints_.empty() || checkpoints_.back().tokenIndex < index)) {
+        checkpoint_(index);
+      }
+      token = tokens[index];
+      if (index + 1 < tokens.size()) {
+        index++;
+      }
+      return token.type != TokenType::__EMPTY;
+    };
+
+    if (checkpoints_.empty()) {
+      return parse_(text, nextToken);
+    }
+
+    index = restore_(checkpoints_.back());
+    return run_(nextToken);
+  }
+
+  /**
+   * Records the checkpoint before reading the token.
+   */
+  void checkpoint_(size_t tokenIndex) {
+    Checkpoint checkpoint;
+    if (!copyValues_(checkpoint.values, valuesStack)) {
+      return;
+    }
+
+    auto text = std::string_view{editedText_};
+
+    checkpoint.tokenIndex = tokenIndex;
+    checkpoint.states = statesStack;
+    checkpoint.errors = errors_.size();
+#if SYNTAX_PARSER_RECOVERY
+    checkpoint.recovering = recovering_;
+#else
+    checkpoint.recovering = 0;
+#endif
+
+    checkpoint.tokens.reserve(tokensStack.size());
+    for (auto view : tokensStack) {
+      if (view.data() >= text.data() &&
+          view.data() + view.size() <= text.data() + text.size()) {
+        checkpoint.tokens.push_back(CheckpointToken{
+            nullptr, (size_t)(view.data() - text.data()), view.size()});
+      } else {
+        checkpoint.tokens.push_back(
+            CheckpointToken{view.data(), 0, view.size()});
+      }
+    }
+
+    checkpoints_.push_back(std::move(checkpoint));
+  }
+
+  /**
+   * Restores the stacks of the checkpoint, returning its token index.
+   */
+  size_t restore_(const Checkpoint& checkpoint) {
+    auto text = std::string_view{editedText_};
+
+    statesStack = checkpoint.states;
+    copyValues_(valuesStack, checkpoint.values);
+
+    tokensStack.clear();
+    for (const auto& token : checkpoint.tokens) {
+      tokensStack.push_back(token.data == nullptr
+                                ? text.substr(token.offset, token.length)
+                                : std::string_view{token.data, token.length});
+    }
+
+    errors_.resize(checkpoint.errors);
+#if SYNTAX_PARSER_RECOVERY
+    recovering_ = checkpoint.recovering;
+#endif
+
+    return checkpoint.tokenIndex;
+  }
+
+  /**
+   * Copies the values, if they are copyable.
+   */
+  template <typename T>
+  static bool copyValues_(std::vector<T>& to, const std::vector<T>& from) {
+    if constexpr (std::is_copy_constructible_v<T>) {
+      to = from;
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  /**
+   * Offset where tokenizing of the token started: the end of the previous
+   * one.
+   */
+  size_t lexStart_(size_t index) const {
+    return index > 0 ? editedTokens_[index - 1].endOffset() : 0;
+  }
+
+  /**
+   * Index of the current tokenizer states in the pool.
+   */
+  uint32_t internLexStates_() {
+    const auto& states = tokenizer.getStates();
+    if (lastLexStates_ < lexStatesPool_.size() &&
+        lexStatesPool_[lastLexStates_] == states) {
+      return lastLexStates_;
+    }
+
+    auto found = std::find(lexStatesPool_.begin(), lexStatesPool_.end(),
+                           states);
+    if (found == lexStatesPool_.end()) {
+      found = lexStatesPool_.insert(found, states);
+    }
+
+    lastLexStates_ = found - lexStatesPool_.begin();
+    return lastLexStates_;
+  }
+#endif
+
+#if SYNTAX_PARSER_THREADS
+  /**
+   * Runs the `work(index)` in `count` workers of the pool (started, or
+   * grown, on demand): the first worker runs in the calling thread.
+   */
+  template <typename Work>
+  void runWorkers_(size_t count, Work&& work) {
+    if (count == 0) {
+      return;
+    }
+    if (!workers_ || workers_->size() < count) {
+      workers_.reset();
+      workers_ = std::make_unique<WorkerPool>(count);
+    }
+    workers_->run(count, work);
+  }
+#endif
+
+  /**
+   * Main parsing loop over the initialized tokenizer. The `str` is passed
+   * to the `onParseBegin` hook (empty when streaming).
+   */
+  ParseResult parse_(std::string_view str) {
+    return parse_(str, [this](Token& token) {
+      return tokenizer.tryGetNextToken(token);
+    });
+  }
+
+  /**
+   * Parses the tokens read by the `nextToken` (the tokenizer, or the
+   * tokens lexed ahead), ending with the EOF token. The `nextToken` returns
+   * false on the unexpected input.
+   */
+  template <typename NextToken>
+  ParseResult parse_(std::string_view str, NextToken&& nextToken) {
+    begin_(str);
+
+    return run_(nextToken);
+  }
+
+  /**
+   * Initializes the parse of the `str`: calls the `onParseBegin` hook, and
+   * resets the stacks to the initial state.
+   */
+  void begin_([[maybe_unused]] std::string_view str) {
+    // clang-format off
+    {{{ON_PARSE_BEGIN_CALL}}}
+    // clang-format on
+
+    // Initialize the stacks.
+    reset();
+
+    // Initial 0 state.
+    statesStack.push_back(0);
+
+    errors_.clear();
+#if SYNTAX_PARSER_RECOVERY
+    recovering_ = 0;
+#endif
+  }
+
+  /**
+   * Parsing loop of the pushed input, resumable between the `feed` calls:
+   * runs until the tokenizer needs more of the input (returns false), or
+   * the parse ends, with the `pushResult_`. The lookahead is reread after
+   * the input is fed, and the discarding of the error recovery resumes.
+   */
+  bool push_() {
+#if SYNTAX_PARSER_STATS
+    StatsTimer timer{stats_.time};
+#endif
+
+    auto starved = false;
+    auto nextToken = [this, &starved](Token& token) {
+      if (tokenizer.tryGetNextToken(token)) {
+        return true;
+      }
+      starved = tokenizer.needsInput();
+      return starved;
+    };
+
+    auto& token = pushToken_;
+
+    for (;;) {
+      if (pushRead_) {
+        if (!nextToken(token) && !onSyntaxError_(token, nextToken)) {
+          pushResult_ = failed_();
+          return true;
+        }
+        if (starved) {
+          return false;
+        }
+        pushRead_ = false;
+      }
+
+      auto state = statesStack.back();
+      auto column = (int)token.type;
+
+      const auto& entry = table_[state * SYMBOLS_COUNT + column];
+
+      if (entry.type() == TE::Error) {
+        if (!onSyntaxError_(token, nextToken)) {
+          pushResult_ = failed_();
+          return true;
+        }
+        if (starved) {
+          pushRead_ = true;
+          return false;
+        }
+      } else if (entry.type() == TE::Shift) {
+        shift_(entry.value(), token, pushShiftedToken_);
+        pushRead_ = true;
+      } else if (entry.type() == TE::Reduce) {
+        tokenizer.yytext = tokenizer.getTokenText(pushShiftedToken_);
+        if (!reduce_(entry.value())) {
+          pushResult_ = stopped_();
+          return true;
+        }
+      } else if (entry.type() == TE::Accept) {
+        pushResult_ = accept_(token);
+        return true;
+      }
+    }
+  }
+
+#if SYNTAX_PARSER_CODED
+  /**
+   * Main parsing loop, from the current state of the stacks (direct-coded,
+   * defined after the handlers).
+   */
+  template <typename NextToken>
+  ParseResult run_(NextToken& nextToken);
+#else
+  /**
+   * Main parsing loop, from the current state of the stacks.
+   */
+  template <typename NextToken>
+  ParseResult run_(NextToken& nextToken) {
+#if SYNTAX_PARSER_STATS
+    StatsTimer timer{stats_.time};
+#endif
+
+    Token token;
+    if (!nextToken(token) && !onSyntaxError_(token, nextToken)) {
+      return failed_();
+    }
+    auto shiftedToken = token;
+
+    // Main parsing loop.
+    for (;;) {
+      auto state = statesStack.back();
+      auto column = (int)token.type;
+
+      const auto& entry = table_[state * SYMBOLS_COUNT + column];
+
+      if (entry.type() == TE::Error) {
+        if (!onSyntaxError_(token, nextToken)) {
+          return failed_();
+        }
+        continue;
+      }
+
+      // Shift a token, go to state.
+      if (entry.type() == TE::Shift) {
+        shift_(entry.value(), token, shiftedToken);
+
+        if (!nextToken(token) && !onSyntaxError_(token, nextToken)) {
+          return failed_();
+        }
+      }
+
+      // Reduce by production.
+      else if (entry.type() == TE::Reduce) {
+        tokenizer.yytext = tokenizer.getTokenText(shiftedToken);
+
+        if (!reduce_(entry.value())) {
+          return stopped_();
+        }
+      }
+
+      // Accept the string.
+      else if (entry.type() == TE::Accept) {
+        return accept_(token);
+      }
+    }
+  }
+#endif
+
+  /**
+   * Shifts the token, going to the `state`: "s5" -> 5.
+   */
+  void shift_(int state, const Token& token, Token& shiftedToken) {
+    // Push token.
+    tokensStack.push_back(tokenizer.getTokenText(token));
+
+    // Push next state number.
+    statesStack.push_back(state);
+
+#if SYNTAX_PARSER_STATS
+    stats_.shifts++;
+    updateMaxDepths_();
+#endif
+
+    shiftedToken = token;
+#if SYNTAX_PARSER_RECOVERY
+    if (recovering_ > 0) {
+      recovering_--;
+    }
+#endif
+  }
+
+  /**
+   * Accepts the string on the `token`: pops the parsed value, which should
+   * be the whole input.
+   */
+  ParseResult accept_(const Token& token) {
+    // Pop state number.
+    statesStack.pop_back();
+
+    // Pop the parsed value.
+    // clang-format off
+    {{{PARSED_RESULT}}}
+    // clang-format on
+
+    if (statesStack.size() != 1 || statesStack.back() != 0 ||
+        tokenizer.hasMoreTokens()) {
+      syntaxError_(token, statesStack.back());
+      return failed_();
+    }
+
+    statesStack.pop_back();
+
+    // clang-format off
+    {{{ON_PARSE_END_CALL}}}
+    // clang-format on
+
+    ParseResult parsed;
+    parsed.value.emplace(std::move(result));
+    if (!errors_.empty()) {
+      parsed.error = errors_.front();
+    }
+    return parsed;
+  }
+
+#if SYNTAX_PARSER_THREADS
+  /**
+   * Parses an input of the batch, catching its error.
+   */
+  static BatchResult parseBatchInput_(yyparse& parser, std::string_view input) {
+    BatchResult result;
+    try {
+      auto parsed = parser.tryParse(input);
+      result.value = std::move(parsed.value);
+      if (!parsed.ok()) {
+        result.errors = parser.syntaxErrors();
+        result.error = parser.formatError(parsed.error);
+      }
+    } catch (const std::exception& e) {
+      result.error = e.what();
+    }
+    return result;
+  }
+#endif
+
+  /**
+   * Semantic action of the production: calls its handler, or, for the
+   * productions passing a value through (`$$ = $1`), only drops the other
+   * arguments from the stacks (defined after the handlers).
+   */
+  static void handle_(yyparse& parser, int productionNumber);
+
+#if SYNTAX_PARSER_CODED
+  /**
+   * Reduces by the production: pops the states of its RHS, calls the
+   * handler, and goes to the state by its LHS (direct-coded). Returns
+   * false if the callback of `parseItems` stops parsing.
+   */
+  bool reduce_(int productionNumber);
+
+  /**
+   * State after the reduction to the `symbol` in the uncovered `state`.
+   */
+  static int goto_(int symbol, int state);
+#else
+  /**
+   * Reduces by the production: pops the states of its RHS, calls the
+   * handler, and goes to the state by its LHS. Returns false if the
+   * callback of `parseItems` stops parsing.
+   */
+  bool reduce_(int productionNumber) {
+    const auto& production = productions_[productionNumber];
+
+    auto rhsLength = production.rhsLength;
+    while (rhsLength > 0) {
+      statesStack.pop_back();
+      rhsLength--;
+    }
+
+    // Call the handler.
+    handle_(*this, productionNumber);
+
+    auto previousState = statesStack.back();
+
+    auto symbolToReduceWith = production.opcode;
+    const auto& nextStateEntry =
+        table_[previousState * SYMBOLS_COUNT + symbolToReduceWith];
+    assert(nextStateEntry.type() == TE::Transit);
+
+    statesStack.push_back(nextStateEntry.value());
+
+#if SYNTAX_PARSER_STATS
+    stats_.reductions[productionNumber]++;
+    updateMaxDepths_();
+#endif
+
+    if (symbolToReduceWith == itemSymbol_) {
+      return yieldItem_(*this);
+    }
+    return true;
+  }
+#endif
+
+  /**
+   * Passes the reduced item of `parseItems` to the callback, if it's at
+   * the top level. Returns false if the callback stops parsing. Only
+   * instantiated by `parseItems`, which requires the default `Value`.
+   */
+  template <typename ItemValue>
+  static bool yieldItemValue_(yyparse& parser) {
+    const auto& statesStack = parser.statesStack;
+    for (auto i = statesStack.size() - 1; i-- > 1;) {
+      if (stateTerminals_[statesStack[i]]) {
+        return true;
+      }
+    }
+
+    auto item = std::move(parser.valuesStack.back());
+    parser.valuesStack.back() = ItemValue{};
+
+    if (!(*parser.itemCallback_)(std::move(item))) {
+      parser.itemsStopped_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Result of the parse stopped by the callback of `parseItems`.
+   */
+  ParseResult stopped_() { return ParseResult{}; }
+
+#if SYNTAX_PARSER_STATS
+  void updateMaxDepths_() {
+    stats_.maxStatesDepth = std::max(stats_.maxStatesDepth, statesStack.size());
+    stats_.maxValuesDepth = std::max(stats_.maxValuesDepth, valuesStack.size());
+    stats_.maxTokensDepth = std::max(stats_.maxTokensDepth, tokensStack.size());
+  }
+
+  static ParserStats emptyStats_() {
+    ParserStats stats;
+    stats.reductions.resize(PRODUCTIONS_COUNT);
+    return stats;
+  }
+#endif
+
+  /**
+   * Records the syntax error on the unexpected token in the `state`.
+   */
+  void syntaxError_(const Token& token, int state) {
+    auto kind = SyntaxErrorKind::UnexpectedToken;
+    if (token.type == TokenType::__EMPTY) {
+      kind = SyntaxErrorKind::UnexpectedInput;
+    } else if (token.type == TokenType::__EOF && !tokenizer.hasMoreTokens()) {
+      kind = SyntaxErrorKind::UnexpectedEnd;
+    }
+
+    errors_.push_back(SyntaxError{kind, token.type, state, token.startOffset,
+                                  token.endOffset()});
+  }
+
+  /**
+   * Result of the failed parse.
+   */
+  ParseResult failed_() {
+    ParseResult parsed;
+    parsed.error = errors_.front();
+    return parsed;
+  }
+
+#if SYNTAX_PARSER_RECOVERY
+  /**
+   * Error recovery, yacc-style: the states are popped until one which
+   * shifts the `error` token, and then the input tokens are discarded until
+   * one which can follow it. New errors are not reported until 3 tokens are
+   * shifted after the error. Returns false if the error is not recoverable:
+   * no state shifts the `error`, or the input ends.
+   */
+  template <typename NextToken>
+  bool onSyntaxError_(Token& token, NextToken& nextToken) {
+    for (;;) {
+      if (recovering_ < 3) {
+        if (recovering_ == 0) {
+          syntaxError_(token, statesStack.back());
+        }
+        recovering_ = 3;
+
+        for (;;) {
+          auto state = statesStack.back();
+
+          const auto& entry =
+              table_[state * SYMBOLS_COUNT + (int)TokenType::error];
+          if (entry.type() == TE::Shift) {
+            tokensStack.push_back(tokenizer.getTokenText(token));
+            statesStack.push_back(entry.value());
+            break;
+          }
+
+          // A state which only reduces is reduced (as with the default
+          // reductions), so the recognized symbols are kept.
+          auto productionNumber = defaultReduction_(state);
+          if (productionNumber >= 0) {
+            if (!reduce_(productionNumber)) {
+              return false;
+            }
+            continue;
+          }
+
+          if (statesStack.size() == 1) {
+            return false;
+          }
+
+          // The symbol of the state is on one of the stacks.
+          if (stateTokens_[statesStack.back()]) {
+            tokensStack.pop_back();
+          } else {
+            valuesStack.pop_back();
+          }
+          statesStack.pop_back();
+        }
+
+        // The unexpected input is always discarded.
+        if (token.type != TokenType::__EMPTY) {
+          return true;
+        }
+      } else if (token.type == TokenType::__EOF) {
+        return false;
+      }
+
+      // Discard the lookahead token.
+      if (nextToken(token)) {
+        return true;
+      }
+    }
+  }
+  /**
+   * The production by which the state reduces on any lookahead, or -1.
+   */
+  static int defaultReduction_(int state) {
+    auto productionNumber = -1;
+    auto row = &table_[state * SYMBOLS_COUNT];
+    for (size_t column = 0; column < SYMBOLS_COUNT; column++) {
+      const auto& entry = row[column];
+      if (entry.type() == TE::Shift || entry.type() == TE::Accept ||
+          (entry.type() == TE::Reduce && productionNumber >= 0 &&
+           entry.value() != productionNumber)) {
+        return -1;
+      }
+      if (entry.type() == TE::Reduce) {
+        productionNumber = entry.value();
+      }
+    }
+    return productionNumber;
+  }
+#else
+  /**
+   * Records the syntax error; the parse fails.
+   */
+  template <typename NextToken>
+  bool onSyntaxError_(Token& token, NextToken&) {
+    syntaxError_(token, statesStack.back());
+    return false;
+  }
+#endif
+
+  /**
+   * Value of a successful parse, or throws its syntax error.
+   */
+  Value valueOrThrow_(ParseResult&& parsed) {
+    if (!parsed.ok()) {
+      throw SyntaxErrorException(formatError(parsed.error), parsed.error);
+    }
+    return std::move(*parsed.value);
+  }
+
+  /**
+   * Syntax errors of the last parse.
+   */
+  std::vector<SyntaxError> errors_;
+
+  /**
+   * The item non-terminal of `parseItems` (-1 otherwise), its callback,
+   * the passing of the items to it, and whether it stopped parsing.
+   */
+  int itemSymbol_ = -1;
+  const ItemCallback* itemCallback_ = nullptr;
+  bool (*yieldItem_)(yyparse& parser) = nullptr;
+  bool itemsStopped_ = false;
+
+  /**
+   * Push parsing: the lookahead (to be read if `pushRead_`), the last
+   * shifted token, and the result once the parse is done.
+   */
+  Token pushToken_;
+  Token pushShiftedToken_;
+  bool pushRead_ = true;
+  bool pushDone_ = true;
+  ParseResult pushResult_;
+
+#if SYNTAX_PARSER_RECOVERY
+  /**
+   * Tokens to shift until the new errors are reported, after an error.
+   */
+  int recovering_ = 0;
+#endif
+
+  /**
+   * Mapping of the file being parsed by `parseFile`.
+   */
+  std::shared_ptr<MappedFile> mappedFile_;
+
+#if SYNTAX_PARSER_ARENA
+  /**
+   * Arena of the semantic values.
+   */
+  std::unique_ptr<Arena> arena_;
+#endif
+
+#if SYNTAX_PARSER_THREADS
+  /**
+   * Threads of the parallel parses, and the parsers of the `parseBatch`
+   * workers (but the first one, this parser).
+   */
+  std::unique_ptr<WorkerPool> workers_;
+  std::vector<std::unique_ptr<yyparse>> batchParsers_;
+#endif
+
+#if SYNTAX_PARSER_THREADS && SYNTAX_PARSER_ARENA
+  /**
+   * Arenas of the `parseBatch` workers.
+   */
+  std::vector<std::unique_ptr<Arena>> batchArenas_;
+#endif
+
+#if SYNTAX_PARSER_REPARSE
+  /**
+   * Text of the editable parsing, its tokens (ending with the EOF), and
+   * the tokenizer states before each token (indices into the pool of the
+   * distinct states).
+   */
+  std::string editedText_;
+  std::vector<Token> editedTokens_;
+  std::vector<uint32_t> editedStates_;
+  std::vector<std::vector<TokenizerState>> lexStatesPool_;
+  uint32_t lastLexStates_ = 0;
+
+  /**
+   * Tokens relexed on an edit, reused between the edits.
+   */
+  std::vector<Token> relexedTokens_;
+  std::vector<uint32_t> relexedStates_;
+
+  /**
+   * Checkpoints of the parsing stacks, in the order of the tokens.
+   */
+  std::vector<Checkpoint> checkpoints_;
+#endif
+
+#if SYNTAX_PARSER_THREADS
+  /**
+   * Tokens of the chunks in `parseParallel`, reused between the calls.
+   */
+  std::vector<std::vector<Token>> chunkTokens_;
+#endif
+
+#if SYNTAX_PARSER_STATS
+  ParserStats stats_ = emptyStats_();
+#endif
+
+  // clang-format off
+  static constexpr size_t PRODUCTIONS_COUNT = {{{PRODUCTIONS_COUNT}}};
+  static constexpr Production productions_[PRODUCTIONS_COUNT] = {{{PRODUCTIONS}}};
+
+  static constexpr size_t ROWS_COUNT = {{{ROWS_COUNT}}};
+  static constexpr size_t SYMBOLS_COUNT = {{{SYMBOLS_COUNT}}};
+
+  /**
+   * Parsing table: an entry per state and encoded symbol.
+   */
+  static constexpr TableEntry table_[ROWS_COUNT * SYMBOLS_COUNT] = {{{TABLE}}};
+
+#if SYNTAX_PARSER_RECOVERY
+  /**
+   * Whether the symbol of a state is kept on the tokens stack (or on the
+   * values stack), for popping the states on the error recovery.
+   */
+  static constexpr bool stateTokens_[ROWS_COUNT] = {{{STATE_TOKENS}}};
+#endif
+
+  /**
+   * Whether the symbol of a state is a terminal, for the top-level items of
+   * `parseItems`.
+   */
+  static constexpr bool stateTerminals_[ROWS_COUNT] = {{{STATE_TERMINALS}}};
+
+#if SYNTAX_PARSER_STATS
+  /**
+   * Productions in the `LHS -> RHS` form.
+   */
+  static constexpr const char* productionNames_[PRODUCTIONS_COUNT] = {{{PRODUCTION_NAMES}}};
+#endif
+  // clang-format on
+};
+
+// ------------------------------------------------------------------
+// Productions.
+
+// clang-format off
+{{{PRODUCTION_HANDLERS}}}
+// clang-format on
+
+inline void yyparse::handle_(yyparse& parser, int productionNumber) {
+  switch (productionNumber) {
+    // clang-format off
+    {{{PRODUCTION_ACTIONS}}}
+    // clang-format on
+  }
+}
+{{{CODED_DRIVER}}}
 }  // namespace syntax
 
 #endif
\ No newline at end of file
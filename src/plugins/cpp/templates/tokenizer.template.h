@@ -21,31 +21,182 @@ enum class TokenType {
 
 // ------------------------------------------------------------------
 // Token.
+//
+// A small trivially-copyable value (16 bytes): the absolute offset of the
+// token in the source, its length, and the token type. The text is
+// accessed as a view into the buffer via `Tokenizer::getTokenText(token)`,
+// and the line and column are resolved on demand, `Tokenizer::locate`.
 
 struct Token {
+  size_t startOffset;
+  uint32_t length;
+
   TokenType type;
-  std::string value;
-
-  int startOffset;
-  int endOffset;
-  int startLine;
-  int endLine;
-  int startColumn;
-  int endColumn;
+
+  size_t endOffset() const { return startOffset + length; }
+};
+
+// ------------------------------------------------------------------
+// Syntax error.
+//
+// A compact record of what was unexpected, and where. The message is
+// formatted only on demand, by `Tokenizer::formatError`.
+
+enum class SyntaxErrorKind : uint8_t {
+  None,
+  UnexpectedInput,  // No lex rule matches the input at the offset.
+  UnexpectedToken,  // The token is not expected in the parser state.
+  UnexpectedEnd,    // The input ends early.
+};
+
+struct SyntaxError {
+  SyntaxErrorKind kind = SyntaxErrorKind::None;
+  TokenType token = TokenType::__EMPTY;
+
+  // Parser state, with the expected tokens; -1 if unknown.
+  int state = -1;
+
+  size_t startOffset = 0;
+  size_t endOffset = 0;
+};
+
+/**
+ * Exception thrown on syntax errors by `parse` (and by `getNextToken`):
+ * the formatted message, and the error record.
+ */
+class SyntaxErrorException : public std::runtime_error {
+ public:
+  SyntaxErrorException(const std::string& message, const SyntaxError& error)
+      : std::runtime_error(message), error(error) {}
+
+  SyntaxError error;
+};
+
+#if SYNTAX_PARSER_STATS
+
+// ------------------------------------------------------------------
+// Tokenizer statistics (`SYNTAX_PARSER_STATS`), accumulated until
+// `Tokenizer::resetStats`. The per-rule counters are indexed by the lex
+// rule, see `Tokenizer::lexRuleName`.
+
+struct TokenizerStats {
+  // Tokens matched by each rule (the skipped ones included).
+  std::vector<uint64_t> ruleMatches;
+
+  // Tries of each rule, and the tries which didn't match (the regex lexer,
+  // the DFA matches all rules of a state at once).
+  std::vector<uint64_t> ruleAttempts;
+  std::vector<uint64_t> ruleFailures;
+
+  // Returned tokens (the EOF, and the unexpected input, included), and the
+  // input bytes which no rule matches.
+  uint64_t tokens = 0;
+  uint64_t unexpectedInputs = 0;
+
+  // Tokenized bytes (of the skipped tokens as well).
+  uint64_t bytesScanned = 0;
+
+  // Time spent in the tokenizer, estimated from the sampled tokens, see
+  // `Tokenizer::STATS_TIME_SAMPLING`.
+  std::chrono::nanoseconds time{0};
+};
+
+/**
+ * Adds the time spent in its scope to the `total`.
+ */
+class StatsTimer {
+ public:
+  explicit StatsTimer(std::chrono::nanoseconds& total)
+      : total_(total), start_(std::chrono::steady_clock::now()) {}
+
+  ~StatsTimer() { total_ += std::chrono::steady_clock::now() - start_; }
+
+ private:
+  std::chrono::nanoseconds& total_;
+  std::chrono::steady_clock::time_point start_;
 };
 
-using SharedToken = std::shared_ptr<Token>;
+#endif
+
+typedef TokenType (*LexRuleHandler)(const Tokenizer&, std::string_view);
+
+#if SYNTAX_LEXER_DFA
+
+// ------------------------------------------------------------------
+// Lex rule: [handler], matching is done by the DFA.
+
+struct LexRule {
+  LexRuleHandler handler;
+};
 
-typedef TokenType (*LexRuleHandler)(const Tokenizer&, const std::string&);
+#else
 
 // ------------------------------------------------------------------
-// Lex rule: [regex, handler]
+// Lex rule: [regex source, handler]
+//
+// The regexes are compiled on the first use, so the rules table itself
+// is constant-initialized, and costs nothing at startup.
 
 struct LexRule {
-  std::regex regex;
+  const char* regex;
   LexRuleHandler handler;
 };
 
+#endif
+
+// ------------------------------------------------------------------
+// Lex rules of a start condition: a span in the rule indices table.
+
+struct LexRulesSpan {
+  size_t offset;
+  size_t count;
+};
+
+// ------------------------------------------------------------------
+// Byte set of up to 4 ranges: `lo[i]` to `lo[i] + span[i]`.
+
+struct ByteRanges {
+  uint8_t lo[4];
+  uint8_t span[4];
+};
+
+#if !SYNTAX_LEXER_DFA
+
+// ------------------------------------------------------------------
+// Shape of a lex rule: literals, bytes of a set, and runs of byte sets (a
+// byte of the `first` set, and the longest run of the `rest` set) are
+// matched without the regex engine. So are the keywords (`\bwhile\b`): a
+// group of the keyword rules is matched by a lookup of the word (the run
+// of the `rest` word bytes) in the `keywords` hash table.
+
+enum class LexRuleShape : uint8_t { Regex, Literal, Byte, Run, Keyword };
+
+struct LexRuleMatcher {
+  LexRuleShape shape;
+  ByteRanges first;
+  ByteRanges rest;
+  std::string_view literal;
+  uint32_t keywords;
+};
+
+// ------------------------------------------------------------------
+// Perfect hash table of a keywords group: `mask + 1` slots from the
+// `offset`, the words hashed with the `seed` have no collisions. A slot
+// has the word, and its lex rule (-1 for the empty slots).
+
+struct KeywordTable {
+  uint32_t seed;
+  uint32_t mask;
+  uint32_t offset;
+};
+
+struct KeywordSlot {
+  std::string_view word;
+  int32_t rule;
+};
+
+#endif
+
 // ------------------------------------------------------------------
 // Token.
 
@@ -60,29 +211,156 @@ enum TokenizerState {
 
 class Tokenizer {
  public:
+  /**
+   * Input source for streaming: reads up to `size` bytes into the
+   * `buffer`, returning the number of bytes read, 0 at the end of input.
+   */
+  using InputSource = std::function<size_t(char* buffer, size_t size)>;
+
+  /**
+   * Default size of the chunks read from an input source.
+   */
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
   /**
    * Initializes a parsing string.
+   *
+   * The tokenizer doesn't copy the string, and works directly on the
+   * passed buffer, which should outlive tokenization.
    */
-  void initString(const std::string& str) {
+  void initString(std::string_view str) {
     str_ = str;
 
+    source_ = nullptr;
+    sourceEnd_ = true;
+    retainedViews_ = nullptr;
+
+    init_();
+  }
+
+  /**
+   * Initializes tokenizing of the `[begin, end)` range of the string.
+   * Offsets (and the located lines and columns) are in the whole string.
+   * Used to tokenize chunks of a string in parallel.
+   */
+  void initRange(std::string_view str, size_t begin, size_t end) {
+    initString(str.substr(0, end));
+
+    cursor_ = begin;
+  }
+
+  /**
+   * Initializes streaming from an input source, which is read in chunks
+   * into a sliding window: only the data starting from the current token
+   * (and from the retained views, see `retainViews`) is kept in memory.
+   *
+   * Token offsets, lines, and columns are absolute in the stream. Token
+   * texts are views into the window, and are valid until the window
+   * slides on one of the next `getNextToken` calls.
+   *
+   * The DFA lexer reads the input as long as a token continues. The regex
+   * lexer matches within at least one chunk ahead of the cursor, and reads
+   * more when a match reaches the end of the window; a rule which would
+   * match only with the input beyond that (e.g. with a lookahead longer
+   * than the chunk) is not seen.
+   */
+  void initStream(InputSource source, size_t chunkSize = DEFAULT_CHUNK_SIZE) {
+    source_ = std::move(source);
+    sourceEnd_ = false;
+    chunkSize_ = chunkSize > 0 ? chunkSize : DEFAULT_CHUNK_SIZE;
+    retainedViews_ = nullptr;
+
+    // The window buffer is reused between the streams.
+    str_ = std::string_view{window_.data(), 0};
+
+    init_();
+  }
+
+  /**
+   * Initializes streaming from an input stream.
+   */
+  void initStream(std::istream& stream,
+                  size_t chunkSize = DEFAULT_CHUNK_SIZE) {
+    initStream(
+        [&stream](char* buffer, size_t size) -> size_t {
+          stream.read(buffer, size);
+          return stream.gcount();
+        },
+        chunkSize);
+  }
+
+  /**
+   * Initializes pushing of the input: the data is appended to the window
+   * by `feed`, as it arrives, and `finishInput` marks its end. Until then,
+   * a token which reaches the end of the fed data (or no match) may change
+   * with more input, so `tryGetNextToken` stops there, and `needsInput` is
+   * true. The window slides as when streaming.
+   */
+  void initPush() {
+    source_ = nullptr;
+    sourceEnd_ = false;
+    retainedViews_ = nullptr;
+
+    str_ = std::string_view{window_.data(), 0};
+
+    init_();
+  }
+
+  /**
+   * Appends the pushed data to the window.
+   */
+  void feed(std::string_view data) {
+    slideWindow_(data.size());
+
+    auto size = str_.length();
+    if (!data.empty()) {
+      std::memcpy(window_.data() + size, data.data(), data.size());
+    }
+    str_ = std::string_view{window_.data(), size + data.size()};
+  }
+
+  /**
+   * Ends the pushed input: the tokens at its end, and the EOF, can be read.
+   */
+  void finishInput() { sourceEnd_ = true; }
+
+  /**
+   * Whether the last `tryGetNextToken` stopped at the end of the pushed
+   * data, which should be `feed` (or finished) to continue. The `__EMPTY`
+   * token is returned then, and nothing is consumed.
+   */
+  bool needsInput() const { return needsInput_; }
+
+  /**
+   * When streaming, keeps the data of these views into the window alive,
+   * moving the views along with the data when the window slides. Used by
+   * the parser for the tokens stack.
+   */
+  void retainViews(std::vector<std::string_view>* views) {
+    retainedViews_ = views;
+  }
+
+ private:
+  void init_() {
+    offset_ = 0;
+
     // Initialize states.
     states_.clear();
     states_.push_back(TokenizerState::INITIAL);
 
     cursor_ = 0;
-    currentLine_ = 1;
-    currentColumn_ = 0;
-    currentLineBeginOffset_ = 0;
+
+    windowLine_ = 1;
+    windowLineBegin_ = 0;
+    lineStartsIndexed_ = false;
+
+    needsInput_ = false;
 
     tokenStartOffset_ = 0;
-    tokenEndOffset_ = 0;
-    tokenStartLine_ = 0;
-    tokenEndLine_ = 0;
-    tokenStartColumn_ = 0;
-    tokenEndColumn_ = 0;
+    tokenLength_ = 0;
   }
 
+ public:
   /**
    * Whether there are still tokens in the stream.
    */
@@ -113,87 +391,347 @@ class Tokenizer {
   }
 
   /**
-   * Returns next token.
+   * The states stack, e.g. to resume tokenizing at a token in the same
+   * states, see `restoreStates`.
    */
-  SharedToken getNextToken() {
-    if (!hasMoreTokens()) {
-      yytext = __EOF;
-      return toToken(TokenType::__EOF);
-    }
+  const std::vector<TokenizerState>& getStates() const { return states_; }
 
-    auto strSlice = str_.substr(cursor_);
+  /**
+   * Restores the states stack.
+   */
+  void restoreStates(const std::vector<TokenizerState>& states) {
+    states_ = states;
+  }
 
-    auto lexRulesForState = lexRulesByStartConditions_.at(getCurrentState());
+  /**
+   * Absolute offset of the cursor: the end of the last read token.
+   */
+  size_t getCursorOffset() const { return offset_ + cursor_; }
 
-    for (const auto& ruleIndex : lexRulesForState) {
-      auto rule = lexRules_[ruleIndex];
-      std::smatch sm;
+  /**
+   * Size of the static lexing tables, in bytes (the regexes, compiled on
+   * the first use, are not included).
+   */
+  static constexpr size_t tablesSize() {
+    return sizeof(lexRules_) + sizeof(lexRulesIndices_) +
+           sizeof(lexRulesByStartConditions_) +
+#if SYNTAX_LEXER_DFA
+           sizeof(dfaClasses_) + sizeof(dfaClassKinds_) +
+           sizeof(dfaTransitions_) + sizeof(dfaAccepts_) +
+           sizeof(dfaStartStates_) + sizeof(dfaRuns_) + sizeof(dfaRunRanges_);
+#else
+           sizeof(lexRulesFirstBytes_) + sizeof(lexRulesMatchers_) +
+           sizeof(keywordTables_) + sizeof(keywordSlots_);
+#endif
+  }
 
-      if (std::regex_search(strSlice, sm, rule.regex)) {
-        yytext = sm[0];
+#if SYNTAX_PARSER_STATS
+  /**
+   * Statistics of the tokenizing, since the creation (or `resetStats`).
+   */
+  const TokenizerStats& stats() const { return stats_; }
 
-        captureLocations_(yytext);
-        cursor_ += yytext.length();
+  void resetStats() { stats_ = emptyStats_(); }
 
-        // Manual handling of EOF token (the end of string). Return it
-        // as `EOF` symbol.
-        if (yytext.length() == 0) {
-          cursor_++;
-        }
+  /**
+   * One of this many tokens is timed: reading the clock costs about as
+   * much as a token.
+   */
+  static constexpr uint64_t STATS_TIME_SAMPLING = 64;
 
-        auto tokenType = rule.handler(*this, yytext);
+  /**
+   * Source of the lex rule, for the per-rule statistics.
+   */
+  static std::string_view lexRuleName(size_t index) {
+    return lexRuleNames_[index];
+  }
+#endif
 
-        if (tokenType == TokenType::__EMPTY) {
-          return getNextToken();
-        }
+  /**
+   * Returns next token, throwing `SyntaxErrorException` on the input which
+   * no lex rule matches.
+   */
+  Token getNextToken() {
+    Token token;
+    if (!tryGetNextToken(token)) {
+      SyntaxError error{SyntaxErrorKind::UnexpectedInput, token.type, -1,
+                        token.startOffset, token.endOffset()};
+      throw SyntaxErrorException(formatError(error), error);
+    }
+    return token;
+  }
 
-        return toToken(tokenType);
+  /**
+   * Reads next token, returning false on the input which no lex rule
+   * matches: the `token` is then the `__EMPTY` one, at the unexpected byte,
+   * which is skipped.
+   *
+   * Skipped tokens (`__EMPTY`, e.g. whitespace and comments) are consumed
+   * in a loop, with constant stack depth.
+   */
+  bool tryGetNextToken(Token& token) {
+#if SYNTAX_PARSER_STATS
+    // The time is sampled: every `STATS_TIME_SAMPLING`-th call is timed.
+    if (++stats_.tokens % STATS_TIME_SAMPLING == 0) {
+      auto start = std::chrono::steady_clock::now();
+      auto matched = matchToken_(token);
+      auto time = std::chrono::steady_clock::now() - start - clockTime_();
+      if (time.count() > 0) {
+        stats_.time += time * STATS_TIME_SAMPLING;
       }
+      return matched;
     }
+#endif
+    return matchToken_(token);
+  }
 
-    if (isEOF()) {
-      cursor_++;
-      yytext = __EOF;
-      return toToken(TokenType::__EOF);
+  /**
+   * Input iterator over the tokens, read lazily by `getNextToken` as it
+   * advances, up to the EOF (which is not included). Throws
+   * `SyntaxErrorException` on the input which no lex rule matches.
+   */
+  class TokenIterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Token;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Token*;
+    using reference = const Token&;
+
+    TokenIterator() = default;
+
+    explicit TokenIterator(Tokenizer* tokenizer) : tokenizer_(tokenizer) {
+      ++*this;
     }
 
-    throwUnexpectedToken(std::string(1, strSlice[0]), currentLine_,
-                         currentColumn_);
-  }
+    reference operator*() const { return token_; }
+    pointer operator->() const { return &token_; }
+
+    TokenIterator& operator++() {
+      token_ = tokenizer_->getNextToken();
+      if (token_.type == TokenType::__EOF) {
+        tokenizer_ = nullptr;
+      }
+      return *this;
+    }
+
+    void operator++(int) { ++*this; }
+
+    bool operator==(const TokenIterator& other) const {
+      return tokenizer_ == other.tokenizer_;
+    }
+
+    bool operator!=(const TokenIterator& other) const {
+      return tokenizer_ != other.tokenizer_;
+    }
+
+   private:
+    Tokenizer* tokenizer_ = nullptr;
+    Token token_{};
+  };
+
+  /**
+   * Lazy range of the tokens of the initialized input, see `tokens`.
+   */
+  struct TokenRange {
+    Tokenizer* tokenizer;
+
+    TokenIterator begin() const { return TokenIterator{tokenizer}; }
+    TokenIterator end() const { return TokenIterator{}; }
+  };
+
+  /**
+   * Tokens of the initialized string (or stream), read lazily while
+   * iterating, so a loop can stop early without tokenizing the rest:
+   *
+   *   for (const auto& token : tokenizer.tokens()) { ... }
+   */
+  TokenRange tokens() { return TokenRange{this}; }
 
   /**
    * Whether the cursor is at the EOF.
    */
-  inline bool isEOF() { return cursor_ == str_.length(); }
+  inline bool isEOF() { return cursor_ == str_.length() && sourceEnd_; }
 
-  SharedToken toToken(TokenType tokenType) {
-    return std::shared_ptr<Token>(new Token{
-        .type = tokenType,
-        .value = yytext,
+  Token toToken(TokenType tokenType) {
+    return Token{
         .startOffset = tokenStartOffset_,
-        .endOffset = tokenEndOffset_,
-        .startLine = tokenStartLine_,
-        .endLine = tokenEndLine_,
-        .startColumn = tokenStartColumn_,
-        .endColumn = tokenEndColumn_,
-    });
+        .length = tokenLength_,
+        .type = tokenType,
+    };
+  }
+
+  /**
+   * Returns the text of a token, a view into the parsing string.
+   */
+  std::string_view getTokenText(const Token& token) const {
+    if (token.type == TokenType::__EOF) {
+      return __EOF;
+    }
+    return str_.substr(token.startOffset - offset_, token.length);
   }
 
   /**
-   * Throws default "Unexpected token" exception, showing the actual
-   * line from the source, pointing with the ^ marker to the bad token.
-   * In addition, shows `line:column` location.
+   * Line and column of a position.
    */
-  [[noreturn]] void throwUnexpectedToken(const std::string& symbol, int line,
-                                         int column) {
-    std::stringstream ss{str_};
-    std::string lineStr;
-    int currentLine = 1;
+  struct Location {
+    uint32_t line;
+    uint32_t column;
+  };
 
-    while (currentLine++ <= line) {
-      std::getline(ss, lineStr, '\n');
+  /**
+   * Resolves the line and column of an absolute offset, by a binary search
+   * over the offsets of the line starts, which are indexed (with `memchr`)
+   * on the first call. When streaming, the offset should be in the window.
+   */
+  Location locate(size_t offset) const {
+    if (!lineStartsIndexed_) {
+      indexLineStarts_();
     }
 
+    auto at = std::min(offset - offset_, str_.length());
+    auto lines = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), at) -
+                 lineStarts_.begin();
+
+    auto lineBegin =
+        lines == 0 ? windowLineBegin_ : offset_ + lineStarts_[lines - 1];
+
+    return Location{(uint32_t)(windowLine_ + lines),
+                    (uint32_t)(offset - lineBegin)};
+  }
+
+  /**
+   * Throws default "Unexpected token" `SyntaxErrorException`, showing the
+   * actual line from the source, pointing with the ^ marker to the bad
+   * token. In addition, shows `line:column` location.
+   *
+   * The `offset` is the absolute offset of the token, from which the line
+   * and column are resolved.
+   */
+  [[noreturn]] void throwUnexpectedToken(std::string_view symbol,
+                                         size_t offset) {
+    auto location = locate(offset);
+
+    SyntaxError error{SyntaxErrorKind::UnexpectedToken, TokenType::__EMPTY,
+                      -1, offset, offset + symbol.length()};
+
+    throw SyntaxErrorException(
+        formatUnexpected_(symbol, location.line, location.column, offset),
+        error);
+  }
+
+  /**
+   * Formats the message of a syntax error, in the format of the
+   * `throwUnexpectedToken`. The offsets of the error should be in the
+   * parsed string (in the window, when streaming).
+   */
+  std::string formatError(const SyntaxError& error) const {
+    if (error.kind == SyntaxErrorKind::UnexpectedEnd) {
+      return "Unexpected end of input.\n";
+    }
+
+    std::string_view symbol = __EOF;
+    if (error.token != TokenType::__EOF && error.startOffset >= offset_) {
+      symbol = str_.substr(std::min(error.startOffset - offset_, str_.length()),
+                           error.endOffset - error.startOffset);
+    }
+
+    auto location = locate(error.startOffset);
+    return formatUnexpected_(symbol, location.line, location.column,
+                             error.startOffset);
+  }
+
+  /**
+   * Matched text, a view into the parsing string.
+   */
+  std::string_view yytext;
+
+ private:
+  /**
+   * Tokenizing loop of `tryGetNextToken`.
+   */
+  bool matchToken_(Token& token) {
+    needsInput_ = false;
+
+    for (;;) {
+      if (!hasMoreTokens()) {
+        yytext = __EOF;
+        token = toToken(TokenType::__EOF);
+        return true;
+      }
+
+      if (!sourceEnd_) {
+        fillWindow_();
+      }
+
+      size_t ruleIndex;
+      size_t length;
+
+      if (!matchRule_(ruleIndex, length)) {
+        if (needsInput_) {
+          token = toToken(TokenType::__EMPTY);
+          return false;
+        }
+        break;
+      }
+
+#if SYNTAX_PARSER_STATS
+      stats_.ruleMatches[ruleIndex]++;
+      stats_.bytesScanned += length;
+#endif
+
+      yytext = str_.substr(cursor_, length);
+
+      captureLocations_(yytext);
+      cursor_ += yytext.length();
+
+      // Manual handling of EOF token (the end of string). Return it
+      // as `EOF` symbol.
+      if (yytext.length() == 0) {
+        cursor_++;
+      }
+
+      auto tokenType = lexRules_[ruleIndex].handler(*this, yytext);
+
+      if (tokenType != TokenType::__EMPTY) {
+        token = toToken(tokenType);
+        return true;
+      }
+    }
+
+    if (isEOF()) {
+      cursor_++;
+      yytext = __EOF;
+      token = toToken(TokenType::__EOF);
+      return true;
+    }
+
+    // The unexpected byte is skipped, so the next call continues after it.
+    captureLocations_(str_.substr(cursor_, 1));
+    cursor_++;
+
+#if SYNTAX_PARSER_STATS
+    stats_.unexpectedInputs++;
+    stats_.bytesScanned++;
+#endif
+
+    token = toToken(TokenType::__EMPTY);
+    return false;
+  }
+
+  /**
+   * Message of the unexpected `symbol` at the `line:column`.
+   */
+  std::string formatUnexpected_(std::string_view symbol, int line, int column,
+                                size_t offset) const {
+    // The line of the token (its part which is still in the window,
+    // when streaming).
+    auto lineBegin = offset - column;
+    lineBegin = lineBegin < offset_ ? 0 : lineBegin - offset_;
+
+    auto lineStr = str_.substr(std::min(lineBegin, str_.length()));
+    lineStr = lineStr.substr(0, lineStr.find('\n'));
+
     auto pad = std::string(column, ' ');
 
     std::stringstream errMsg;
@@ -203,45 +741,440 @@ class Tokenizer {
            << pad << "^\nUnexpected token \"" << symbol << "\" at " << line
            << ":" << column << "\n\n";
 
-    std::cerr << errMsg.str();
-    throw new std::runtime_error(errMsg.str().c_str());
+    return errMsg.str();
   }
 
   /**
-   * Matched text.
+   * Reads the next chunk from the input source, sliding the window.
+   * Returns the number of discarded bytes, by which the cursor moves.
    */
-  std::string yytext;
+  size_t refill_() {
+    auto keep = slideWindow_(chunkSize_);
+
+    auto size = str_.length();
+    auto read = source_(window_.data() + size, chunkSize_);
+
+    if (read == 0) {
+      sourceEnd_ = true;
+    }
+
+    str_ = std::string_view{window_.data(), size + read};
+
+    return keep;
+  }
 
- private:
   /**
-   * Captures token locations.
+   * Slides the window, making room for the `extra` bytes after the data:
+   * the data before the cursor, and before the retained views, is
+   * discarded. Returns the number of discarded bytes.
    */
-  void captureLocations_(const std::string& matched) {
-    auto len = matched.length();
+  size_t slideWindow_(size_t extra) {
+    auto keep = cursor_;
 
-    // Absolute offsets.
-    tokenStartOffset_ = cursor_;
+    if (retainedViews_ != nullptr) {
+      for (const auto& view : *retainedViews_) {
+        if (inWindow_(view)) {
+          keep = std::min(keep, (size_t)(view.data() - str_.data()));
+        }
+      }
+    }
 
-    // Line-based locations, start.
-    tokenStartLine_ = currentLine_;
-    tokenStartColumn_ = tokenStartOffset_ - currentLineBeginOffset_;
+    // Lines of the discarded data, for `locate`.
+    if (keep > 0) {
+      auto begin = str_.data();
+      auto end = begin + keep;
+      for (auto p = begin;
+           (p = (const char*)std::memchr(p, '\n', end - p)) != nullptr;
+           p++) {
+        windowLine_++;
+        windowLineBegin_ = offset_ + (p - begin) + 1;
+      }
+    }
+    lineStartsIndexed_ = false;
+
+    auto size = str_.length() - keep;
+    auto needed = size + extra;
+
+    auto moveViews = [&](const char* data) {
+      if (retainedViews_ == nullptr) {
+        return;
+      }
+      for (auto& view : *retainedViews_) {
+        if (inWindow_(view)) {
+          view = std::string_view{data + (view.data() - str_.data()) - keep,
+                                  view.length()};
+        }
+      }
+    };
 
-    // Extract `\n` in the matched token.
-    std::stringstream ss{matched};
-    std::string lineStr;
-    std::getline(ss, lineStr, '\n');
-    while (ss.tellg() > 0 && ss.tellg() <= len) {
-      currentLine_++;
-      currentLineBeginOffset_ = tokenStartOffset_ + ss.tellg();
-      std::getline(ss, lineStr, '\n');
+    if (window_.size() < needed) {
+      std::vector<char> grown(std::max(needed, 2 * window_.size()));
+      if (size > 0) {
+        std::memcpy(grown.data(), str_.data() + keep, size);
+      }
+      moveViews(grown.data());
+      window_.swap(grown);
+    } else if (size > 0) {
+      std::memmove(window_.data(), str_.data() + keep, size);
+      moveViews(window_.data());
     }
 
-    tokenEndOffset_ = cursor_ + len;
+    str_ = std::string_view{window_.data(), size};
+    offset_ += keep;
+    cursor_ -= keep;
 
-    // Line-based locations, end.
-    tokenEndLine_ = currentLine_;
-    tokenEndColumn_ = tokenEndOffset_ - currentLineBeginOffset_;
-    currentColumn_ = tokenEndColumn_;
+    return keep;
+  }
+
+  /**
+   * Whether the view points into the window.
+   */
+  bool inWindow_(std::string_view view) {
+    auto lessEqual = std::less_equal<const char*>{};
+    return str_.data() != nullptr && lessEqual(str_.data(), view.data()) &&
+           lessEqual(view.data(), str_.data() + str_.length());
+  }
+
+  /**
+   * Fills the window before matching a token. The DFA lexer reads more
+   * while scanning, so needs at least one byte; the regex lexer needs
+   * a chunk ahead of the cursor.
+   */
+  void fillWindow_() {
+#if SYNTAX_LEXER_DFA
+    size_t ahead = 1;
+#else
+    size_t ahead = chunkSize_;
+#endif
+    while (source_ && !sourceEnd_ && str_.length() - cursor_ < ahead) {
+      refill_();
+    }
+  }
+
+#if SYNTAX_LEXER_DFA
+
+  /**
+   * Runs the DFA from the cursor, finding the first rule (in the order of
+   * the lex grammar) which matches there, and its longest match. When
+   * pushing, a match up to the end of the fed data needs more input.
+   */
+  bool matchRule_(size_t& ruleIndex, size_t& length) {
+    size_t state = dfaStartStates_[getCurrentState()];
+    auto rule = -1;
+
+    auto p = cursor_;
+
+    for (;;) {
+      // When streaming, the input is read while the token continues.
+      if (p == str_.length() && !sourceEnd_) {
+        if (!source_) {
+          needsInput_ = true;
+          return false;
+        }
+        p -= refill_();
+        continue;
+      }
+
+      auto n = str_.length();
+      auto byteClass = p < n ? dfaClasses_[(unsigned char)str_[p]] : 0;
+
+      // Accepting rule depends on the next position kind because of
+      // the `\b` and `$` assertions: non-word, word, or end of input.
+      auto nextKind = p < n ? dfaClassKinds_[byteClass] : 2;
+      int accept = dfaAccepts_[state * 3 + nextKind];
+
+      if (accept >= 0 && (rule < 0 || accept <= rule)) {
+        rule = accept;
+        length = p - cursor_;
+      }
+
+      if (p == n) {
+        break;
+      }
+
+      auto nextState = dfaTransitions_[state * DFA_CLASSES_COUNT + byteClass];
+
+      // Dead state.
+      if (nextState == 0) {
+        break;
+      }
+
+      p++;
+
+      // On the second byte of a self-loop run (e.g. of `\s+`), skips to the
+      // last byte of the run: the accepting rule is the same along it.
+      if (DFA_RUNS_COUNT > 0 && nextState == state && dfaRuns_[state] >= 0) {
+        auto run = scanRanges_(str_.data() + p, str_.data() + n,
+                               dfaRunRanges_[dfaRuns_[state]]);
+        if (run > 1) {
+          p += run - 1;
+        }
+      }
+
+      state = nextState;
+    }
+
+    if (rule < 0) {
+      return false;
+    }
+
+    ruleIndex = rule;
+    return true;
+  }
+
+#else
+
+  /**
+   * Matches a rule at the cursor. When streaming, a match up to the end
+   * of the window (or no match) may change with more input, in which case
+   * more is read, and the rules are matched again (or, when pushing, more
+   * input is needed).
+   */
+  bool matchRule_(size_t& ruleIndex, size_t& length) {
+    for (;;) {
+      auto matched = matchRuleInWindow_(ruleIndex, length);
+
+      if (sourceEnd_ || (matched && cursor_ + length < str_.length())) {
+        return matched;
+      }
+
+      if (!source_) {
+        needsInput_ = true;
+        return false;
+      }
+
+      refill_();
+    }
+  }
+
+  /**
+   * Tries the rules of the current state in order, matching them in place
+   * at the cursor.
+   */
+  bool matchRuleInWindow_(size_t& ruleIndex, size_t& length) {
+    auto begin = str_.data() + cursor_;
+    auto end = str_.data() + str_.length();
+
+    const auto& span = lexRulesByStartConditions_[getCurrentState()];
+
+    // Current byte (any rule can match at the end of the string).
+    auto atEnd = begin == end;
+    auto c = atEnd ? 0 : (unsigned char)*begin;
+
+    for (auto i = span.offset; i < span.offset + span.count; i++) {
+      auto index = lexRulesIndices_[i];
+
+      if (!atEnd && !((lexRulesFirstBytes_[index][c >> 6] >> (c & 63)) & 1)) {
+        continue;
+      }
+
+#if SYNTAX_PARSER_STATS
+      stats_.ruleAttempts[index]++;
+#endif
+
+      const auto& matcher = lexRulesMatchers_[index];
+
+      if (matcher.shape == LexRuleShape::Literal) {
+        auto size = matcher.literal.size();
+        if ((size_t)(end - begin) >= size &&
+            std::memcmp(begin, matcher.literal.data(), size) == 0) {
+          ruleIndex = index;
+          length = size;
+          return true;
+        }
+      } else if (matcher.shape == LexRuleShape::Byte ||
+                 matcher.shape == LexRuleShape::Run) {
+        if (!atEnd && inRanges_(c, matcher.first)) {
+          ruleIndex = index;
+          length = matcher.shape == LexRuleShape::Byte
+                       ? 1
+                       : 1 + scanRanges_(begin + 1, end, matcher.rest);
+          return true;
+        }
+      } else if (matcher.shape == LexRuleShape::Keyword) {
+        auto size = scanRanges_(begin, end, matcher.rest);
+        auto rule = lookupKeyword_(matcher.keywords, {begin, size});
+        if (rule >= 0) {
+          ruleIndex = rule;
+          length = size;
+          return true;
+        }
+      } else if (std::regex_search(begin, end, match_, lexRuleRegex_(index),
+                                   std::regex_constants::match_continuous)) {
+        ruleIndex = index;
+        length = match_.length(0);
+        return true;
+      }
+
+#if SYNTAX_PARSER_STATS
+      stats_.ruleFailures[index]++;
+#endif
+    }
+
+    return false;
+  }
+
+  /**
+   * Lex rule of the keyword in the table of a keywords group, or -1. The
+   * hash is FNV-1a, with the high bits folded into the low ones.
+   */
+  static int lookupKeyword_(uint32_t table, std::string_view word) {
+    const auto& keywords = keywordTables_[table];
+
+    auto hash = keywords.seed;
+    for (auto c : word) {
+      hash = (hash ^ (uint8_t)c) * 16777619u;
+    }
+    hash ^= hash >> 16;
+
+    const auto& slot = keywordSlots_[keywords.offset + (hash & keywords.mask)];
+    return slot.word == word ? slot.rule : -1;
+  }
+
+  /**
+   * Returns compiled regex of a rule. All regexes are compiled once, on
+   * the first call (thread-safe static initialization).
+   */
+  static const std::regex& lexRuleRegex_(size_t index) {
+    static const auto regexes = compileLexRules_();
+    return regexes[index];
+  }
+
+  static std::vector<std::regex> compileLexRules_() {
+    std::vector<std::regex> regexes;
+    regexes.reserve(LEX_RULES_COUNT);
+    for (const auto& rule : lexRules_) {
+      regexes.emplace_back(rule.regex);
+    }
+    return regexes;
+  }
+
+#endif
+
+  /**
+   * Whether the byte is in the ranges.
+   */
+  static bool inRanges_(uint8_t c, const ByteRanges& ranges) {
+    return (uint8_t)(c - ranges.lo[0]) <= ranges.span[0] ||
+           (uint8_t)(c - ranges.lo[1]) <= ranges.span[1] ||
+           (uint8_t)(c - ranges.lo[2]) <= ranges.span[2] ||
+           (uint8_t)(c - ranges.lo[3]) <= ranges.span[3];
+  }
+
+  /**
+   * Returns the length of the run of bytes in the ranges from `p`. The
+   * blocks of 32 (AVX2) or 16 (SSE2, NEON) bytes are checked at once, with
+   * a byte `c` in a range if `c - lo` (wrapping) is at most `span`.
+   */
+  static size_t scanRanges_(const char* p, const char* end,
+                            const ByteRanges& ranges) {
+    auto begin = p;
+
+#if SYNTAX_LEXER_SIMD_AVX2
+    __m256i lo[4], span[4];
+    for (int i = 0; i < 4; i++) {
+      lo[i] = _mm256_set1_epi8((char)ranges.lo[i]);
+      span[i] = _mm256_set1_epi8((char)ranges.span[i]);
+    }
+    while (end - p >= 32) {
+      auto bytes = _mm256_loadu_si256((const __m256i*)p);
+      auto in = _mm256_setzero_si256();
+      for (int i = 0; i < 4; i++) {
+        auto offset = _mm256_sub_epi8(bytes, lo[i]);
+        in = _mm256_or_si256(
+            in, _mm256_cmpeq_epi8(_mm256_min_epu8(offset, span[i]), offset));
+      }
+      auto outside = ~(uint32_t)_mm256_movemask_epi8(in);
+      if (outside != 0) {
+        return p - begin + countTrailingZeros_(outside);
+      }
+      p += 32;
+    }
+#elif SYNTAX_LEXER_SIMD_SSE2
+    __m128i lo[4], span[4];
+    for (int i = 0; i < 4; i++) {
+      lo[i] = _mm_set1_epi8((char)ranges.lo[i]);
+      span[i] = _mm_set1_epi8((char)ranges.span[i]);
+    }
+    while (end - p >= 16) {
+      auto bytes = _mm_loadu_si128((const __m128i*)p);
+      auto in = _mm_setzero_si128();
+      for (int i = 0; i < 4; i++) {
+        auto offset = _mm_sub_epi8(bytes, lo[i]);
+        in = _mm_or_si128(
+            in, _mm_cmpeq_epi8(_mm_min_epu8(offset, span[i]), offset));
+      }
+      auto outside = ~(uint32_t)_mm_movemask_epi8(in) & 0xffff;
+      if (outside != 0) {
+        return p - begin + countTrailingZeros_(outside);
+      }
+      p += 16;
+    }
+#elif SYNTAX_LEXER_SIMD_NEON
+    uint8x16_t lo[4], span[4];
+    for (int i = 0; i < 4; i++) {
+      lo[i] = vdupq_n_u8(ranges.lo[i]);
+      span[i] = vdupq_n_u8(ranges.span[i]);
+    }
+    while (end - p >= 16) {
+      auto bytes = vld1q_u8((const uint8_t*)p);
+      auto in = vdupq_n_u8(0);
+      for (int i = 0; i < 4; i++) {
+        in = vorrq_u8(in, vcleq_u8(vsubq_u8(bytes, lo[i]), span[i]));
+      }
+      // 4 bits per byte.
+      auto outside = ~vget_lane_u64(
+          vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(in), 4)), 0);
+      if (outside != 0) {
+        return p - begin + countTrailingZeros_(outside) / 4;
+      }
+      p += 16;
+    }
+#endif
+
+    while (p < end && inRanges_((uint8_t)*p, ranges)) {
+      p++;
+    }
+
+    return p - begin;
+  }
+
+  static unsigned countTrailingZeros_(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return index;
+#else
+    return __builtin_ctzll(x);
+#endif
+  }
+
+  /**
+   * Indexes the offsets of the line starts in the string (the window, when
+   * streaming), relative to its beginning.
+   */
+  void indexLineStarts_() const {
+    lineStarts_.clear();
+    lineStartsIndexed_ = true;
+
+    if (str_.empty()) {
+      return;
+    }
+
+    auto begin = str_.data();
+    auto end = begin + str_.length();
+    for (auto p = begin;
+         (p = (const char*)std::memchr(p, '\n', end - p)) != nullptr; p++) {
+      lineStarts_.push_back(p - begin + 1);
+    }
+  }
+
+  /**
+   * Captures the token location: its absolute offset, and length.
+   */
+  void captureLocations_(std::string_view matched) {
+    tokenStartOffset_ = offset_ + cursor_;
+    tokenLength_ = (uint32_t)matched.length();
   }
 
   /**
@@ -249,24 +1182,112 @@ class Tokenizer {
    */
   // clang-format off
   static constexpr size_t LEX_RULES_COUNT = {{{LEX_RULES_COUNT}}};
-  static std::array<LexRule, LEX_RULES_COUNT> lexRules_;
-  static std::map<TokenizerState, std::vector<size_t>> lexRulesByStartConditions_;
+  static const std::array<LexRule, LEX_RULES_COUNT> lexRules_;
+  // clang-format on
+
+#if SYNTAX_PARSER_STATS
+  /**
+   * Sources of the lex rules.
+   */
+  // clang-format off
+  static constexpr const char* lexRuleNames_[LEX_RULES_COUNT] = {{{LEX_RULE_NAMES}}};
+  // clang-format on
+
+  /**
+   * Time of reading the clock, which is subtracted from the samples.
+   */
+  static std::chrono::steady_clock::duration clockTime_() {
+    static const auto time = [] {
+      auto min = std::chrono::steady_clock::duration::max();
+      for (int i = 0; i < 64; i++) {
+        auto start = std::chrono::steady_clock::now();
+        min = std::min(min, std::chrono::steady_clock::now() - start);
+      }
+      return min;
+    }();
+    return time;
+  }
+
+  static TokenizerStats emptyStats_() {
+    TokenizerStats stats;
+    stats.ruleMatches.resize(LEX_RULES_COUNT);
+    stats.ruleAttempts.resize(LEX_RULES_COUNT);
+    stats.ruleFailures.resize(LEX_RULES_COUNT);
+    return stats;
+  }
+#endif
+
+  /**
+   * Lex rules by start conditions: a span of indices per state.
+   */
+  // clang-format off
+  {{{LEX_RULES_BY_START_CONDITIONS}}}
+  // clang-format on
+
+  /**
+   * Lexer DFA tables (empty for the regex lexer).
+   */
+  // clang-format off
+  {{{LEX_DFA}}}
+  // clang-format on
+
+  /**
+   * Bytes each lex rule can start with (empty for the DFA lexer).
+   */
+  // clang-format off
+  {{{LEX_RULES_FIRST_BYTES}}}
+  // clang-format on
+
+  /**
+   * Shapes of the lex rules, and the keyword tables (empty for the DFA
+   * lexer).
+   */
+  // clang-format off
+  {{{LEX_RULES_MATCHERS}}}
   // clang-format on
 
   /**
    * Special EOF token.
    */
-  static std::string __EOF;
+  static constexpr std::string_view __EOF{"$"};
 
   /**
-   * Tokenizing string.
+   * Tokenizing string (not owned), or the window, when streaming (or
+   * pushing).
    */
-  std::string str_;
+  std::string_view str_;
+
+  /**
+   * Absolute offset of the `str_` in the input (non-zero when streaming).
+   */
+  size_t offset_;
+
+  /**
+   * Streaming: the input source, the window buffer, and the views into
+   * the window which are retained when it slides.
+   */
+  InputSource source_;
+  bool sourceEnd_ = true;
+  size_t chunkSize_ = DEFAULT_CHUNK_SIZE;
+  std::vector<char> window_;
+  std::vector<std::string_view>* retainedViews_ = nullptr;
+
+  /**
+   * Pushing: whether the last token needs more of the input.
+   */
+  bool needsInput_ = false;
+
+#if !SYNTAX_LEXER_DFA
+  /**
+   * Match results, reused between the rules and tokens.
+   */
+  std::cmatch match_;
+#endif
 
   /**
    * Cursor for current symbol.
    */
-  int cursor_;
+  size_t cursor_;
 
   /**
    * States.
@@ -274,28 +1295,29 @@ class Tokenizer {
   std::vector<TokenizerState> states_;
 
   /**
-   * Line-based location tracking.
+   * Lazy location resolving (`locate`): the line, and the offset of the
+   * beginning of the line, at the beginning of the window, and the index
+   * of the line starts in the window.
    */
-  int currentLine_;
-  int currentColumn_;
-  int currentLineBeginOffset_;
+  uint32_t windowLine_;
+  size_t windowLineBegin_;
+  mutable std::vector<size_t> lineStarts_;
+  mutable bool lineStartsIndexed_;
 
   /**
-   * Location data of a matched token.
+   * Location of a matched token.
    */
-  int tokenStartOffset_;
-  int tokenEndOffset_;
-  int tokenStartLine_;
-  int tokenEndLine_;
-  int tokenStartColumn_;
-  int tokenEndColumn_;
+  size_t tokenStartOffset_;
+  uint32_t tokenLength_;
+
+#if SYNTAX_PARSER_STATS
+  TokenizerStats stats_ = emptyStats_();
+#endif
 };
 
 // ------------------------------------------------------------------
 // Lexical rule handlers.
 
-std::string Tokenizer::__EOF("$");
-
 // clang-format off
 {{{LEX_RULE_HANDLERS}}}
 // clang-format on
@@ -304,8 +1326,7 @@ std::string Tokenizer::__EOF("$");
 // Lexical rules.
 
 // clang-format off
-std::array<LexRule, Tokenizer::LEX_RULES_COUNT> Tokenizer::lexRules_ = {{{LEX_RULES}}};
-std::map<TokenizerState, std::vector<size_t>> Tokenizer::lexRulesByStartConditions_ = {{{LEX_RULES_BY_START_CONDITIONS}}};
+const std::array<LexRule, Tokenizer::LEX_RULES_COUNT> Tokenizer::lexRules_ = {{{LEX_RULES}}};
 // clang-format on
 
 #endif
\ No newline at end of file